@@ -0,0 +1,182 @@
+/*
+ * Pebble Round Timer - benchmark scenarios
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "common.h"
+#include "timers.h"
+#include "stats.h"
+#include "bench.h"
+
+#ifdef ROUNDTIMER_BENCH
+
+// The scenarios run on the real handlers, but rather than wait for the
+// app timer we jump the wheel straight to whatever is due next. Every
+// such jump is a wakeup the watch would have had. The pebble clock is
+// made to follow the wheel so the clock resyncs happen as they would.
+// To keep the system happy we hand control back every BENCH_CHUNK steps.
+
+#define BENCH_COOKIE 0xBE4C
+#define BENCH_CHUNK 2000
+
+#define MINUTE 60000
+#define HOUR (60 * MINUTE)
+
+typedef struct {
+    const char *name;
+    time_t round;
+    time_t warning;
+    time_t rest;
+    int rounds;
+    uint32_t length;
+    uint32_t lap_every; // 0 for no laps
+    uint32_t pause_every; // 0 for no pauses
+    uint32_t pause_for;
+} BenchScenario;
+
+static const BenchScenario scenarios[] = {
+    // Lengths are wall time, pauses included.
+    { "one_second_rounds", 1000, 0, 0, 0, 99 * HOUR, 0, 0, 0 },
+    { "tabata", 20000, 3000, 10000, 8, 4 * MINUTE, 0, 0, 0 },
+    { "boxing", 3 * MINUTE, 10000, MINUTE, 12, 48 * MINUTE, 30000, 0, 0 },
+    { "pause_heavy", MINUTE, 10000, 15000, 10, 15 * MINUTE, 0, 20000, 5000 },
+};
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static AppContextRef bench_app;
+static time_t epoch;
+static unsigned int scenario = 0;
+static uint32_t at;
+static uint32_t next_lap;
+static uint32_t next_toggle;
+static bool paused;
+static uint32_t cycles;
+#ifdef ROUNDTIMER_STATS_CYCLES
+static uint32_t counted_to;
+#endif
+
+static time_t simulated_seconds() {
+    return epoch + timers_now() / 1000;
+}
+
+static void scenario_begin() {
+    const BenchScenario *s = &scenarios[scenario];
+    round_time = s->round;
+    warning_time = s->warning;
+    rest_time = s->rest;
+    total_round_count = s->rounds;
+    reset_stopwatch(false);
+    STATS_RESET();
+    at = 0;
+    next_lap = s->lap_every;
+    next_toggle = s->pause_every;
+    paused = false;
+    toggle_stopwatch_handler(NULL, NULL);
+}
+
+// Only time spent stepping counts, not what happens between chunks.
+static void count_cycles() {
+#ifdef ROUNDTIMER_STATS_CYCLES
+    uint32_t now = stats_cycles();
+    cycles += now - counted_to;
+    counted_to = now;
+#endif
+}
+
+static void scenario_end() {
+    const BenchScenario *s = &scenarios[scenario];
+    APP_LOG(APP_LOG_LEVEL_INFO, "{\"bench\":\"%s\",\"simulated_ms\":%lu,\"cycles\":%lu}", s->name,
+        (unsigned long)at, (unsigned long)cycles);
+    STATS_LOG_SUMMARY();
+}
+
+// Runs up to BENCH_CHUNK steps. Returns false once every scenario is done.
+static bool bench_chunk() {
+    for(int step = 0; step < BENCH_CHUNK; ++step) {
+        const BenchScenario *s = &scenarios[scenario];
+        uint32_t until = s->length;
+        if(s->lap_every && next_lap < until) until = next_lap;
+        if(s->pause_every && next_toggle < until) until = next_toggle;
+
+        if(at < until) {
+            uint32_t due = timers_until_next();
+            if(due <= until - at) {
+                timers_fast_forward(due);
+                at += due;
+                STAT_INC(STAT_WAKEUPS);
+                STATS_FRAME_END();
+            } else {
+                timers_fast_forward(until - at);
+                at = until;
+            }
+            continue;
+        }
+
+        if(at >= s->length) {
+            count_cycles();
+            scenario_end();
+            if(++scenario == SCENARIO_COUNT) return false;
+            scenario_begin();
+            count_cycles();
+            cycles = 0;
+            continue;
+        }
+        if(s->lap_every && at >= next_lap) {
+            lap_time_handler(NULL, NULL);
+            next_lap += s->lap_every;
+        }
+        if(s->pause_every && at >= next_toggle) {
+            toggle_stopwatch_handler(NULL, NULL);
+            paused = !paused;
+            next_toggle += paused ? s->pause_for : s->pause_every;
+        }
+        STATS_FRAME_END();
+    }
+    count_cycles();
+    return true;
+}
+
+void bench_start(AppContextRef ctx) {
+    bench_app = ctx;
+    epoch = get_pebble_seconds();
+    set_pebble_seconds_source(simulated_seconds);
+    // The config window is on top at launch, and nothing animates or
+    // redraws under it, so bring up the main window as a user would.
+    window_stack_push(&main_window, false);
+    scenario_begin();
+    app_timer_send_event(bench_app, 1, BENCH_COOKIE);
+}
+
+void bench_handle_event(AppContextRef ctx, AppTimerHandle handle, uint32_t cookie) {
+    if(cookie != BENCH_COOKIE) return;
+#ifdef ROUNDTIMER_STATS_CYCLES
+    counted_to = stats_cycles();
+#endif
+    if(bench_chunk()) {
+        app_timer_send_event(bench_app, 1, BENCH_COOKIE);
+    } else {
+        APP_LOG(APP_LOG_LEVEL_INFO, "{\"bench\":\"done\"}");
+    }
+}
+
+#endif
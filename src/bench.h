@@ -0,0 +1,50 @@
+/*
+ * Pebble Round Timer - benchmark scenarios header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+// Uncomment to run a fixed set of sessions through the app at simulated
+// time when it starts. Each one is logged with the stats summary, so it
+// needs ROUNDTIMER_STATS too (and ROUNDTIMER_STATS_CYCLES for timings).
+// tools/bench_compare.py reads the log and checks it against a baseline;
+// tools/bench_host.py builds the app on the host and runs it there.
+// The simulated clock runs far ahead of the watch's, so restart the app
+// before using it for real.
+//#define ROUNDTIMER_BENCH
+
+#ifdef ROUNDTIMER_BENCH
+
+#ifndef ROUNDTIMER_STATS
+#error ROUNDTIMER_BENCH needs ROUNDTIMER_STATS
+#endif
+
+void bench_start(AppContextRef ctx);
+void bench_handle_event(AppContextRef ctx, AppTimerHandle handle, uint32_t cookie);
+
+#define BENCH_START(ctx) bench_start(ctx)
+#define BENCH_HANDLE_EVENT(ctx, handle, cookie) bench_handle_event(ctx, handle, cookie)
+
+#else
+
+#define BENCH_START(ctx)
+#define BENCH_HANDLE_EVENT(ctx, handle, cookie)
+
+#endif
@@ -0,0 +1,161 @@
+/*
+ * Pebble Round Timer - shared clock
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "common.h"
+#include "timers.h"
+#include "clock.h"
+#include "stats.h"
+#include "trace.h"
+
+// We want hundredths of a second, but Pebble won't give us that.
+// Pebble's timers are also too inaccurate (we run fast for some reason)
+// Instead, we count our own time on the timer wheel but also adjust
+// ourselves every pebble clock tick. We keep where the clock stood at the
+// first tick, and every second edge since is a whole number of seconds on
+// from there. This should ensure that we always have accurate times.
+// Every round timer reads this one clock.
+//
+// The anchor is kept for the life of the app, pauses and all. Nothing
+// ticks while every timer is paused, so on the way back we only know which
+// second we're in; see clock_resume() for how that gets patched up.
+static time_t skew = 0;
+static bool anchored = false;
+static time_t anchor_seconds = 0;
+static time_t anchor_at = 0;
+static time_t last_seconds = 0;
+// Where the last edge was on the clock, and the clock at the last look.
+static time_t edge_at = 0;
+static time_t synced_at = 0;
+static bool settling = false;
+static time_t settle_from = 0;
+
+// Ticks aim a little past each edge so the pebble clock has surely turned.
+#define PHASE_MARGIN 5
+
+time_t clock_now() {
+    return timers_now() + skew;
+}
+
+// The clock only moves when the wheel wakes, so something that happens
+// in between, like a button press, happened somewhere from now up to the
+// next wakeup. Halfway is right on average; taking now would have every
+// stop lose half a tick. Straight after a resume the next edge puts the
+// clock right anyway, and brings along whatever was read off it.
+time_t clock_between() {
+    if(settling) return clock_now();
+    return clock_now() + timers_wait_left() / 2;
+}
+
+// Where the edge into the given pebble second falls on the clock. Only
+// whole seconds are multiplied up, so this doesn't overflow the way the
+// pebble time in milliseconds would.
+static time_t edge_time(time_t seconds) {
+    return anchor_at + (seconds - anchor_seconds) * 1000;
+}
+
+// Returns the correction that anything read off the clock since *since has
+// to move by as well, which is only ever non-zero straight after a resume.
+// *moved says whether the clock was corrected at all.
+time_t clock_sync(time_t *since, bool *moved) {
+    time_t correction = 0;
+    bool settled = false;
+    *moved = false;
+    time_t seconds = get_pebble_seconds();
+    if(!last_seconds) last_seconds = seconds;
+    if(seconds > last_seconds) {
+        time_t now = clock_now();
+        // If it's the first tick, instead of changing our time we remember where it was.
+        if(!anchored) {
+            anchor_seconds = seconds;
+            anchor_at = now;
+            anchored = true;
+        } else {
+            // The edge came after the last look and no later than now. A
+            // clock that agrees with that stays put, so ticks landing the
+            // same way every second don't nudge it. One that doesn't is
+            // taken to have found the edge where ticks aim, just past it,
+            // which leaves the next edge landing between two ticks again.
+            time_t edge = edge_time(seconds);
+            time_t found = now - PHASE_MARGIN > synced_at ? now - PHASE_MARGIN : now;
+            if(edge > now || edge < synced_at) correction = edge - found;
+            // Time the wheel missed goes to the wheel, so whatever is
+            // waiting on it isn't late. The wheel can't go back, though.
+            if(correction > 0) timers_credit(correction);
+            else skew += correction;
+            *moved = correction != 0;
+            STAT_INC(STAT_RESYNCS);
+            STAT_MAX(STAT_MAX_CORRECTION, correction < 0 ? -correction : correction);
+        }
+        TRACE_EDGE(now, correction);
+        edge_at = edge_time(seconds);
+        last_seconds = seconds;
+        if(settling) {
+            settling = false;
+            settled = true;
+            *since = settle_from;
+        }
+    }
+    synced_at = clock_now();
+    return settled ? correction : 0;
+}
+
+// Called when ticking starts again after everything was paused. We jump
+// to the start of the current second, which is as much as we know. The
+// first second edge then puts the clock right, and whatever was anchored
+// in between moves with it so the time we did count isn't thrown away.
+void clock_resume() {
+    last_seconds = get_pebble_seconds();
+    if(!anchored) return;
+    time_t floor = edge_time(last_seconds);
+    if(floor > clock_now()) skew += floor - clock_now();
+    settling = true;
+    settle_from = clock_now();
+    synced_at = settle_from;
+}
+
+// Where we are within the current period, counting from the last second
+// edge as the clock saw it.
+static time_t phase(time_t period) {
+    time_t into = (clock_now() - edge_at) % period;
+    return into < 0 ? into + period : into;
+}
+
+// How long to wait so that the next tick lands just after a multiple of
+// period since a second edge. Keeping every tick at the same point in the
+// second means the resync never finds us at a different place in it, so
+// the tenths don't hop. Until the first edge there's nothing to line up with.
+time_t clock_phase_delay(time_t period) {
+    if(!anchored) return period;
+    time_t into = phase(period);
+#ifdef ROUNDTIMER_STATS
+    // How far off the mark this tick landed, either way.
+    time_t off = (into - PHASE_MARGIN + period) % period;
+    STAT_MAX(STAT_MAX_PHASE_ERROR, off > period / 2 ? period - off : off);
+#endif
+    time_t delay = (period - into + PHASE_MARGIN) % period;
+    // A tick that came a touch early shouldn't be followed by another straight away.
+    if(delay < period / 4) delay += period;
+    return delay;
+}
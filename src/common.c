@@ -25,6 +25,9 @@
 #include "pebble_app.h"
 #include "pebble_fonts.h"
 
+#include "common.h"
+#include "replay.h"
+
 Window main_window;
 
 time_t round_time = 60000;
@@ -51,9 +54,17 @@ void itoa2(int num, char* buffer) {
     buffer[1] = digits[num % 10];
 }
 
-// Milliseconds since January 1st 2012 in some timezone, discounting leap years.
+static SecondsSource seconds_source = NULL;
+
+// Lets the clock be driven by something other than the watch, e.g. simulated time.
+void set_pebble_seconds_source(SecondsSource source) {
+    seconds_source = source;
+}
+
+// Seconds since January 1st 2012 in some timezone, discounting leap years.
 // There must be a better way to do this...
-time_t get_pebble_time() {
+time_t get_pebble_seconds() {
+    if(seconds_source) return seconds_source();
     PblTm t;
     get_time(&t);
     time_t seconds = t.tm_sec;
@@ -61,7 +72,8 @@ time_t get_pebble_time() {
     seconds += t.tm_hour * 3600;
     seconds += t.tm_yday * 86400;
     seconds += (t.tm_year - 2012) * 31536000;
-    return seconds * 1000;
+    REPLAY_SECONDS(seconds);
+    return seconds;
 }
 
 void format_lap(time_t lap_time, char* buffer) {
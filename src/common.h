@@ -28,9 +28,16 @@ extern time_t warning_time;
 extern time_t rest_time;
 extern int total_round_count;
 
+typedef time_t (*SecondsSource)();
+
 void itoa1(int i, char* a);
 void itoa2(int i, char* a);
-time_t get_pebble_time();
+void set_pebble_seconds_source(SecondsSource source);
+time_t get_pebble_seconds();
 void format_lap(time_t time, char* buffer);
 
 void reset_stopwatch(bool keep_running);
+void reset_all_work();
+void main_config_provider(ClickConfig **config, Window *window);
+void toggle_stopwatch_handler(ClickRecognizerRef recognizer, Window *window);
+void lap_time_handler(ClickRecognizerRef recognizer, Window *window);
@@ -26,11 +26,16 @@
 #include "pebble_fonts.h"
 
 #include "common.h"
+#include "stats.h"
 #include "config.h"
+#include "deferred.h"
+#include "replay.h"
+#include "history_view.h"
 
 #define START_MENU_NUMBER 7
 #define COUNT_MENU_NUMBER 6
-#define TOTAL_MENU_NUMBER 8
+#define HISTORY_MENU_NUMBER 8
+#define TOTAL_MENU_NUMBER 9
 
 static Window config_window;
 
@@ -38,6 +43,7 @@ static TextLayer round_text_time_layer;
 static TextLayer warning_text_time_layer;
 static TextLayer rest_text_time_layer;
 static TextLayer start_text;
+static TextLayer history_text;
 static TextLayer time_selectors[6];
 static TextLayer time_separators[3];
 static TextLayer round_text_counter_layer;
@@ -94,6 +100,14 @@ void update_selections() {
         text_layer_set_background_color(&start_text, GColorBlack);
         text_layer_set_text_color(&start_text, GColorWhite);
     }
+    if (selection == HISTORY_MENU_NUMBER) {
+        text_layer_set_background_color(&history_text, GColorWhite);
+        text_layer_set_text_color(&history_text, GColorBlack);
+    }
+    else {
+        text_layer_set_background_color(&history_text, GColorBlack);
+        text_layer_set_text_color(&history_text, GColorWhite);
+    }
     if (selection == COUNT_MENU_NUMBER) {
         text_layer_set_background_color(&round_counter_layer, GColorWhite);
         text_layer_set_text_color(&round_counter_layer, GColorBlack);
@@ -106,7 +120,8 @@ void update_selections() {
 }
 
 void window_appear(Window *window) {
-    reset_stopwatch(false);
+    REPLAY_APPEARED(REPLAY_CONFIG_WINDOW);
+    deferred_post(DEFER_RESET_ALL);
 }
 
 void init_config_window() {
@@ -132,6 +147,8 @@ void init_config_window() {
     layer_add_child(root_layer, &rest_text_time_layer.layer);
     init_text_layer(&round_text_counter_layer, GRect(0, 64, 63, 21), "Count:", GTextAlignmentLeft);
     layer_add_child(root_layer, &round_text_counter_layer.layer);
+    init_text_layer(&history_text, GRect(0, 106, 144, 21), "History", GTextAlignmentCenter);
+    layer_add_child(root_layer, &history_text.layer);
     init_text_layer(&start_text, GRect(0, 127, 144, 21), "Start", GTextAlignmentCenter);
     layer_add_child(root_layer, &start_text.layer);
 
@@ -169,9 +186,13 @@ void change_selection_down(ClickRecognizerRef recognizer, Window *window) {
     change_selection(1);
 }
 
+// The reset can't wait for the queue: a start pressed on the main window
+// before it drained would be undone. That includes the reset this window
+// posted when it appeared, if that hasn't run yet.
 void make_watch_go(ClickRecognizerRef recognizer, Window *window) {
+    deferred_cancel(DEFER_RESET_ALL);
+    reset_all_work();
     window_stack_push(&main_window, true);
-    reset_stopwatch(false);
 }
 
 void go_up(ClickRecognizerRef recognizer, Window *window) {
@@ -179,6 +200,10 @@ void go_up(ClickRecognizerRef recognizer, Window *window) {
         make_watch_go(NULL, NULL);
         return;
     }
+    else if (selection == HISTORY_MENU_NUMBER) {
+        show_history();
+        return;
+    }
     else if (selection == 6) {
         total_round_count += 1;
         total_round_count = (total_round_count > 99) ? 99 : total_round_count;
@@ -212,6 +237,10 @@ void go_down(ClickRecognizerRef recognizer, Window *window) {
         make_watch_go(NULL, NULL);
         return;
     }
+    else if (selection == HISTORY_MENU_NUMBER) {
+        show_history();
+        return;
+    }
     else if (selection == 6) {
         total_round_count -= 1;
         total_round_count = (total_round_count < 0) ? 0 : total_round_count;
@@ -250,6 +279,7 @@ void config_config_provider(ClickConfig **config, Window *window) {
     config[BUTTON_ID_UP]->click.repeat_interval_ms = 150;
     config[BUTTON_ID_DOWN]->click.handler = (ClickHandler)go_down;
     config[BUTTON_ID_DOWN]->click.repeat_interval_ms = 150;
+    REPLAY_CLICKS(REPLAY_CONFIG_WINDOW, config);
     (void)window;
 }
 
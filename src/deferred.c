@@ -0,0 +1,63 @@
+/*
+ * Pebble Round Timer - deferred work
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "timers.h"
+#include "deferred.h"
+
+// Click handlers shouldn't do anything heavier than say what they want.
+// Intents pile up as bits and get drained together once per display
+// frame, in the order they're listed in deferred.h.
+
+#define FRAME_INTERVAL 33
+
+static DeferredWork work_table[DEFER_INTENT_COUNT];
+static uint32_t posted = 0;
+static Timer drain_timer;
+
+static void drain(void *data) {
+    while(posted) {
+        int intent = __builtin_ctz(posted);
+        posted &= ~(1u << intent);
+        if(work_table[intent]) work_table[intent]();
+    }
+}
+
+void deferred_init() {
+    timer_init(&drain_timer, drain, NULL);
+}
+
+void deferred_register(DeferredIntent intent, DeferredWork work) {
+    work_table[intent] = work;
+}
+
+void deferred_post(DeferredIntent intent) {
+    posted |= 1u << intent;
+    if(!timer_is_pending(&drain_timer)) timer_schedule(&drain_timer, FRAME_INTERVAL);
+}
+
+// For work that makes another intent redundant.
+void deferred_cancel(DeferredIntent intent) {
+    posted &= ~(1u << intent);
+}
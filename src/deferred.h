@@ -0,0 +1,39 @@
+/*
+ * Pebble Round Timer - deferred work header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+// Things a click handler can ask for. Anything posted more than once
+// before the queue is drained only gets done once.
+typedef enum {
+    DEFER_RESET_ALL = 0,
+    DEFER_RESET_TIMER,
+    DEFER_SHOW_TIMER,
+    DEFER_REDRAW,
+    DEFER_INTENT_COUNT
+} DeferredIntent;
+
+typedef void (*DeferredWork)();
+
+void deferred_init();
+void deferred_register(DeferredIntent intent, DeferredWork work);
+void deferred_post(DeferredIntent intent);
+void deferred_cancel(DeferredIntent intent);
@@ -0,0 +1,188 @@
+/*
+ * Pebble Round Timer - session export
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "common.h"
+#include "timers.h"
+#include "session.h"
+#include "export.h"
+#include "stats.h"
+
+// Finished sessions wait here until the phone has acknowledged them.
+// Whatever fits in one AppMessage goes out at once; if it fails, or
+// there's no phone, we back off and try again for as long as the app
+// runs. When the queue is full the oldest session that isn't on its way
+// makes way.
+
+#define EXPORT_QUEUE_SIZE 8
+#define EXPORT_MAX_BATCH_BYTES (EXPORT_OUTBOUND_SIZE - 16)
+#define RETRY_MIN 1000
+#define RETRY_MAX 60000
+
+static SessionRecord queue[EXPORT_QUEUE_SIZE];
+static uint16_t sequences[EXPORT_QUEUE_SIZE];
+static int queue_head = 0;
+static int queue_length = 0;
+static uint16_t next_sequence = 0;
+static uint32_t launch = 0;
+static int in_flight = 0;
+static uint32_t retry_delay = RETRY_MIN;
+static Timer retry_timer;
+
+static void put16(uint8_t *frame, uint16_t value) {
+    frame[0] = value;
+    frame[1] = value >> 8;
+}
+
+static void put32(uint8_t *frame, uint32_t value) {
+    put16(frame, value);
+    put16(frame + 2, value >> 16);
+}
+
+static int frames_needed(SessionRecord *session) {
+    return 1 + (session->lap_count + EXPORT_LAPS_PER_FRAME - 1) / EXPORT_LAPS_PER_FRAME;
+}
+
+static uint8_t *pack_session(uint8_t *frame, SessionRecord *session, uint16_t sequence) {
+    memset(frame, 0, EXPORT_FRAME_SIZE);
+    frame[0] = EXPORT_FRAME_SESSION;
+    if(session->program) frame[1] = EXPORT_FLAG_PROGRAM;
+    put16(frame + 2, sequence);
+    put32(frame + 4, session->start);
+    put16(frame + 8, session->round_seconds);
+    put16(frame + 10, session->warning_seconds);
+    put16(frame + 12, session->rest_seconds);
+    frame[14] = session->round_count;
+    frame[15] = session->rounds_done;
+    put32(frame + 16, session->elapsed);
+    put32(frame + 20, session->paused);
+    frame[24] = session->lap_count;
+    put32(frame + 25, launch);
+    frame += EXPORT_FRAME_SIZE;
+
+    for(int lap = 0; lap < session->lap_count; lap += EXPORT_LAPS_PER_FRAME) {
+        memset(frame, 0, EXPORT_FRAME_SIZE);
+        frame[0] = EXPORT_FRAME_LAPS;
+        frame[1] = lap;
+        put16(frame + 2, sequence);
+        for(int i = 0; i < EXPORT_LAPS_PER_FRAME && lap + i < session->lap_count; ++i) {
+            put16(frame + 4 + i * 2, session->laps[lap + i]);
+        }
+        frame += EXPORT_FRAME_SIZE;
+    }
+    return frame;
+}
+
+static void back_off(AppMessageResult reason) {
+    // No phone means there's no point trying again soon.
+    retry_delay = reason == APP_MSG_NOT_CONNECTED ? RETRY_MAX : retry_delay * 2;
+    if(retry_delay > RETRY_MAX) retry_delay = RETRY_MAX;
+    timer_schedule(&retry_timer, retry_delay);
+}
+
+static void export_send() {
+    if(in_flight || !queue_length) return;
+
+    static uint8_t batch[EXPORT_MAX_BATCH_BYTES];
+    uint8_t *end = batch;
+    int count = 0;
+    while(count < queue_length) {
+        int index = (queue_head + count) % EXPORT_QUEUE_SIZE;
+        if(end + frames_needed(&queue[index]) * EXPORT_FRAME_SIZE > batch + sizeof(batch)) break;
+        end = pack_session(end, &queue[index], sequences[index]);
+        ++count;
+    }
+
+    DictionaryIterator *iter;
+    if(app_message_out_get(&iter) != APP_MSG_OK) {
+        timer_schedule(&retry_timer, retry_delay);
+        return;
+    }
+    if(dict_write_data(iter, EXPORT_KEY_FRAMES, batch, end - batch) != DICT_OK) {
+        app_message_out_release();
+        back_off(APP_MSG_SEND_REJECTED);
+        return;
+    }
+    dict_write_end(iter);
+    // Nothing's on its way unless the send got going; neither callback
+    // comes for one that didn't.
+    AppMessageResult result = app_message_out_send();
+    app_message_out_release();
+    if(result != APP_MSG_OK) back_off(result);
+    else in_flight = count;
+}
+
+static void retry(void *data) {
+    export_send();
+}
+
+static void out_sent(DictionaryIterator *sent, void *context) {
+    // The phone has them, so they can go.
+    queue_head = (queue_head + in_flight) % EXPORT_QUEUE_SIZE;
+    queue_length -= in_flight;
+    in_flight = 0;
+    retry_delay = RETRY_MIN;
+    export_send();
+}
+
+static void out_failed(DictionaryIterator *failed, AppMessageResult reason, void *context) {
+    in_flight = 0;
+    back_off(reason);
+}
+
+static AppMessageCallbacksNode callbacks = {
+    .callbacks = {
+        .out_sent = out_sent,
+        .out_failed = out_failed
+    }
+};
+
+void export_init() {
+    launch = get_pebble_seconds();
+    timer_init(&retry_timer, retry, NULL);
+    app_message_register_callbacks(&callbacks);
+}
+
+void export_queue(SessionRecord *session) {
+    if(queue_length == EXPORT_QUEUE_SIZE) {
+        STAT_INC(STAT_EXPORT_DROPS);
+        // Never drop what's in flight; the acknowledgement would clear the
+        // wrong sessions. If that's all of them, this one has to go.
+        if(in_flight == queue_length) return;
+        // The ones in flight are at the head, so close up over the oldest after them.
+        for(int i = in_flight; i < queue_length - 1; ++i) {
+            int to = (queue_head + i) % EXPORT_QUEUE_SIZE;
+            int from = (to + 1) % EXPORT_QUEUE_SIZE;
+            queue[to] = queue[from];
+            sequences[to] = sequences[from];
+        }
+        --queue_length;
+    }
+    int index = (queue_head + queue_length) % EXPORT_QUEUE_SIZE;
+    queue[index] = *session;
+    sequences[index] = next_sequence++;
+    ++queue_length;
+    if(!timer_is_pending(&retry_timer)) export_send();
+}
@@ -0,0 +1,51 @@
+/*
+ * Pebble Round Timer - session export header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+// Sessions go out as fixed-size frames, little-endian throughout.
+// Every frame starts with its kind, a flags/index byte and the session's
+// sequence number. Sequences start over every time the app does, so the
+// session frame also carries the launch time; the phone drops anything
+// whose launch and sequence it has already seen when an acknowledgement
+// goes missing.
+//
+// Session frame:
+//   0 EXPORT_FRAME_SESSION, 1 flags (EXPORT_FLAG_PROGRAM if the loaded
+//       interval program set the schedule, so round and rest are 0),
+//   2-3 sequence, 4-7 start (seconds),
+//   8-9 round, 10-11 warning, 12-13 rest (seconds), 14 round count,
+//   15 rounds done, 16-19 elapsed, 20-23 paused (tenths), 24 lap count,
+//   25-28 launch (seconds on the pebble clock when the app started)
+// Lap frame, as many as it takes:
+//   0 EXPORT_FRAME_LAPS, 1 index of the first lap, 2-3 sequence,
+//   4-31 up to 14 lap times (tenths)
+#define EXPORT_FRAME_SIZE 32
+#define EXPORT_FRAME_SESSION 1
+#define EXPORT_FRAME_LAPS 2
+#define EXPORT_FLAG_PROGRAM 2
+#define EXPORT_LAPS_PER_FRAME 14
+
+#define EXPORT_KEY_FRAMES 1
+#define EXPORT_OUTBOUND_SIZE 256
+
+void export_init();
+void export_queue(SessionRecord *session);
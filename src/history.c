@@ -0,0 +1,179 @@
+/*
+ * Pebble Round Timer - session history
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "session.h"
+#include "history.h"
+
+// The last HISTORY_SIZE sessions, newest first by index. Each field gets
+// its own array so a list screen only touches the columns it shows.
+// Totals per program are brought up to date as each session comes in,
+// so nothing here ever has to walk the history.
+
+static uint32_t starts[HISTORY_SIZE];
+static uint8_t program_ids[HISTORY_SIZE];
+static uint8_t rounds[HISTORY_SIZE];
+static uint32_t work_times[HISTORY_SIZE];
+static uint32_t rest_times[HISTORY_SIZE];
+static uint8_t lap_counts[HISTORY_SIZE];
+static uint16_t best_laps[HISTORY_SIZE];
+static uint16_t best_rounds[HISTORY_SIZE];
+static int history_next = 0;
+static int history_length = 0;
+
+static HistoryProgram programs[HISTORY_PROGRAMS];
+static uint32_t program_used[HISTORY_PROGRAMS]; // start of its latest session
+static int program_length = 0;
+
+static int find_program(SessionRecord *session) {
+    int oldest = 0;
+    for(int id = 0; id < program_length; ++id) {
+        HistoryProgram *program = &programs[id];
+        if(program->program == session->program &&
+           program->round_seconds == session->round_seconds &&
+           program->warning_seconds == session->warning_seconds &&
+           program->rest_seconds == session->rest_seconds &&
+           program->round_count == session->round_count) {
+            return id;
+        }
+        if(program_used[id] < program_used[oldest]) oldest = id;
+    }
+
+    // Out of room: the program used longest ago starts over, and any of
+    // its sessions still in the history lose their program.
+    int id = oldest;
+    if(program_length < HISTORY_PROGRAMS) {
+        id = program_length++;
+    } else {
+        for(int slot = 0; slot < HISTORY_SIZE; ++slot) {
+            if(program_ids[slot] == id) program_ids[slot] = HISTORY_NO_PROGRAM;
+        }
+    }
+    HistoryProgram *program = &programs[id];
+    memset(program, 0, sizeof(*program));
+    program->program = session->program;
+    program->round_seconds = session->round_seconds;
+    program->warning_seconds = session->warning_seconds;
+    program->rest_seconds = session->rest_seconds;
+    program->round_count = session->round_count;
+    program->best_round = HISTORY_NO_ROUND;
+    return id;
+}
+
+void history_add(SessionRecord *session) {
+    uint32_t work = session->work;
+    uint32_t rest = session->elapsed - work;
+
+    uint16_t best_lap = HISTORY_NO_LAP;
+    for(int i = 0; i < session->lap_count; ++i) {
+        if(session->laps[i] < best_lap) best_lap = session->laps[i];
+    }
+
+    int id = find_program(session);
+    HistoryProgram *program = &programs[id];
+    if(session->start > program_used[id]) program_used[id] = session->start;
+    ++program->sessions;
+    program->work += work;
+    program->rest += rest;
+    if(session->best_round < program->best_round) program->best_round = session->best_round;
+    if(session->rounds_done > program->most_rounds) program->most_rounds = session->rounds_done;
+
+    // Sessions arrive as they finish, and with several timers running one
+    // that started last week can finish after this week's first. Only a
+    // later week starts the totals over; an earlier one isn't counted.
+    uint16_t week = session->start / HISTORY_WEEK_SECONDS;
+    if(week > program->week) {
+        program->week = week;
+        program->week_sessions = 0;
+        program->week_work = 0;
+        program->week_rest = 0;
+    }
+    if(week == program->week) {
+        ++program->week_sessions;
+        program->week_work += work;
+        program->week_rest += rest;
+    }
+
+    int slot = history_next;
+    history_next = (history_next + 1) % HISTORY_SIZE;
+    if(history_length < HISTORY_SIZE) ++history_length;
+    starts[slot] = session->start;
+    program_ids[slot] = id;
+    rounds[slot] = session->rounds_done;
+    work_times[slot] = work;
+    rest_times[slot] = rest;
+    lap_counts[slot] = session->lap_count;
+    best_laps[slot] = best_lap;
+    best_rounds[slot] = session->best_round;
+}
+
+int history_count() {
+    return history_length;
+}
+
+// Index 0 is the most recent session.
+static int history_slot(int index) {
+    return (history_next - 1 - index + HISTORY_SIZE) % HISTORY_SIZE;
+}
+
+uint32_t history_start(int index) {
+    return starts[history_slot(index)];
+}
+
+uint8_t history_program_id(int index) {
+    return program_ids[history_slot(index)];
+}
+
+uint8_t history_rounds(int index) {
+    return rounds[history_slot(index)];
+}
+
+uint32_t history_work(int index) {
+    return work_times[history_slot(index)];
+}
+
+uint32_t history_rest(int index) {
+    return rest_times[history_slot(index)];
+}
+
+uint8_t history_lap_count(int index) {
+    return lap_counts[history_slot(index)];
+}
+
+uint16_t history_best_lap(int index) {
+    return best_laps[history_slot(index)];
+}
+
+uint16_t history_best_round(int index) {
+    return best_rounds[history_slot(index)];
+}
+
+int history_program_count() {
+    return program_length;
+}
+
+HistoryProgram *history_program(int id) {
+    return &programs[id];
+}
@@ -0,0 +1,61 @@
+/*
+ * Pebble Round Timer - session history header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#define HISTORY_SIZE 32
+#define HISTORY_PROGRAMS 8
+#define HISTORY_NO_LAP 0xFFFF
+#define HISTORY_NO_ROUND SESSION_NO_ROUND
+#define HISTORY_NO_PROGRAM 0xFF
+#define HISTORY_WEEK_SECONDS (7 * 86400)
+
+// Running totals for one program, i.e. one set of round, warning and
+// rest times and round count, or the loaded interval program with its
+// warning. Times are in tenths of a second.
+typedef struct {
+    bool program;
+    uint16_t round_seconds;
+    uint16_t warning_seconds;
+    uint16_t rest_seconds;
+    uint8_t round_count;
+    uint16_t sessions;
+    uint32_t work;
+    uint32_t rest;
+    uint16_t best_round; // HISTORY_NO_ROUND until a round is finished
+    uint16_t most_rounds;
+    uint16_t week; // weeks since January 1st 2012, the latest one with sessions
+    uint16_t week_sessions;
+    uint32_t week_work;
+    uint32_t week_rest;
+} HistoryProgram;
+
+void history_add(SessionRecord *session);
+int history_count();
+uint32_t history_start(int index);
+uint8_t history_program_id(int index);
+uint8_t history_rounds(int index);
+uint32_t history_work(int index);
+uint32_t history_rest(int index);
+uint8_t history_lap_count(int index);
+uint16_t history_best_lap(int index);
+uint16_t history_best_round(int index);
+int history_program_count();
+HistoryProgram *history_program(int id);
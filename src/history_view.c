@@ -0,0 +1,131 @@
+/*
+ * Pebble Round Timer - session history window
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "pebble_fonts.h"
+
+#include "common.h"
+#include "session.h"
+#include "history.h"
+#include "history_view.h"
+
+// The best round and this week's work for whatever ran last, then the
+// latest sessions, one a row: rounds done and time spent working. It's
+// all read off history.c's columns and totals when the window comes up,
+// so opening it costs the same however much has been kept.
+
+#define HISTORY_ROWS 10
+#define ROW_HEIGHT 22
+#define ROW_STRING_LENGTH 16
+
+static Window window;
+static ScrollLayer scroll_view;
+static TextLayer best_layer;
+static TextLayer week_layer;
+static TextLayer session_layers[HISTORY_ROWS];
+static TextLayer no_history_note;
+static GFont history_font;
+
+static char best_text[ROW_STRING_LENGTH] = "Best 00:00:00.0";
+static char week_text[ROW_STRING_LENGTH] = "Week 00:00:00.0";
+static char session_text[HISTORY_ROWS][ROW_STRING_LENGTH];
+
+void history_appear(Window *window);
+
+static void init_row(TextLayer *layer, int row, char *text) {
+    text_layer_init(layer, GRect(0, row * ROW_HEIGHT, 144, ROW_HEIGHT));
+    text_layer_set_background_color(layer, GColorClear);
+    text_layer_set_font(layer, history_font);
+    text_layer_set_text_color(layer, GColorBlack);
+    text_layer_set_text(layer, text);
+    scroll_layer_add_child(&scroll_view, &layer->layer);
+}
+
+void init_history_window() {
+    window_init(&window, "History");
+    window_set_background_color(&window, GColorWhite);
+    window_set_window_handlers(&window, (WindowHandlers){
+        .appear = (WindowHandler)history_appear
+    });
+
+    scroll_layer_init(&scroll_view, GRect(0, 0, 144, 152));
+    scroll_layer_set_click_config_onto_window(&scroll_view, &window);
+
+    history_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DEJAVU_SANS_SUBSET_18));
+
+    init_row(&best_layer, 0, best_text);
+    init_row(&week_layer, 1, week_text);
+    for(int i = 0; i < HISTORY_ROWS; ++i) {
+        strcpy(session_text[i], "00r 00:00:00.0");
+        init_row(&session_layers[i], i + 2, session_text[i]);
+    }
+
+    layer_add_child(window_get_root_layer(&window), &scroll_view.layer);
+
+    text_layer_init(&no_history_note, GRect(0, 61, 144, 30));
+    text_layer_set_background_color(&no_history_note, GColorClear);
+    text_layer_set_font(&no_history_note, history_font);
+    text_layer_set_text_color(&no_history_note, GColorBlack);
+    text_layer_set_text_alignment(&no_history_note, GTextAlignmentCenter);
+    text_layer_set_text(&no_history_note, "No sessions yet.");
+    layer_add_child(window_get_root_layer(&window), &no_history_note.layer);
+}
+
+void show_history() {
+    window_stack_push(&window, true);
+}
+
+void history_appear(Window *window) {
+    int count = history_count();
+    int shown = count < HISTORY_ROWS ? count : HISTORY_ROWS;
+    layer_set_hidden(&no_history_note.layer, count != 0);
+    layer_set_hidden(&best_layer.layer, count == 0);
+    layer_set_hidden(&week_layer.layer, count == 0);
+
+    // Totals go with the latest session's program, unless a busier one
+    // since pushed it out.
+    uint8_t id = count ? history_program_id(0) : HISTORY_NO_PROGRAM;
+    HistoryProgram *program = id != HISTORY_NO_PROGRAM ? history_program(id) : NULL;
+    if(program && program->best_round != HISTORY_NO_ROUND) {
+        format_lap(program->best_round * 100, &best_text[5]);
+    } else {
+        memcpy(&best_text[5], "--:--:--.-", 10);
+    }
+    // The week's totals only start over when a session comes in, so a
+    // program last used before this week has done nothing in it.
+    uint32_t week = get_pebble_seconds() / HISTORY_WEEK_SECONDS;
+    format_lap(program && program->week == week ? program->week_work * 100 : 0, &week_text[5]);
+    layer_mark_dirty(&best_layer.layer);
+    layer_mark_dirty(&week_layer.layer);
+
+    for(int i = 0; i < HISTORY_ROWS; ++i) {
+        layer_set_hidden(&session_layers[i].layer, i >= shown);
+        if(i >= shown) continue;
+        itoa2(history_rounds(i), &session_text[i][0]);
+        format_lap(history_work(i) * 100, &session_text[i][4]);
+        layer_mark_dirty(&session_layers[i].layer);
+    }
+    scroll_layer_set_content_size(&scroll_view, GSize(144, count ? (shown + 2) * ROW_HEIGHT : 0));
+    scroll_layer_set_content_offset(&scroll_view, GPoint(0, 0), false);
+}
@@ -27,6 +27,7 @@
 
 #include "laps.h"
 #include "common.h"
+#include "stats.h"
 
 static Window window;
 static ScrollLayer scroll_view;
@@ -0,0 +1,88 @@
+/*
+ * Pebble Round Timer - interval programs
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "program.h"
+
+static ProgramHeader header;
+static ProgramSegment segments[PROGRAM_MAX_SEGMENTS];
+
+// An empty or unreadable program leaves us on the round/warning/rest settings.
+void program_load() {
+    ResHandle handle = resource_get_handle(RESOURCE_ID_PROGRAM);
+    header.count = 0;
+    if(resource_size(handle) < sizeof(header)) return;
+    resource_load_byte_range(handle, 0, (uint8_t *)&header, sizeof(header));
+    if(header.magic[0] != 'R' || header.magic[1] != 'P' || header.version != PROGRAM_VERSION ||
+       header.count > PROGRAM_MAX_SEGMENTS ||
+       resource_size(handle) < sizeof(header) + header.count * sizeof(ProgramSegment)) {
+        header.count = 0;
+        return;
+    }
+    resource_load_byte_range(handle, sizeof(header), (uint8_t *)segments, header.count * sizeof(ProgramSegment));
+}
+
+bool program_loaded() {
+    return header.count != 0;
+}
+
+int program_rounds() {
+    return header.rounds;
+}
+
+time_t program_length() {
+    return header.count ? segments[header.count - 1].end : 0;
+}
+
+// How much of the first elapsed ms was spent in work segments.
+time_t program_work(time_t elapsed) {
+    time_t work = 0;
+    time_t begin = 0;
+    for(int i = 0; i < header.count && begin < elapsed; ++i) {
+        time_t end = segments[i].end;
+        if(segments[i].kind == PROGRAM_WORK) work += (end < elapsed ? end : elapsed) - begin;
+        begin = end;
+    }
+    return work;
+}
+
+// The index of the segment elapsed falls in, or the segment count once
+// the program is over.
+int program_segment(time_t elapsed) {
+    if(elapsed < 0) elapsed = 0;
+    int low = 0;
+    int high = header.count;
+    while(low < high) {
+        int middle = (low + high) / 2;
+        if((time_t)segments[middle].end > elapsed) high = middle;
+        else low = middle + 1;
+    }
+    return low;
+}
+
+// The segment elapsed falls in, or NULL once the program is over.
+ProgramSegment *program_find(time_t elapsed) {
+    int index = program_segment(elapsed);
+    return index < header.count ? &segments[index] : NULL;
+}
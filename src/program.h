@@ -0,0 +1,64 @@
+/*
+ * Pebble Round Timer - interval program header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// An interval program is a table of segments compiled on the host by
+// tools/program_compile.py and shipped as a raw resource. The layout is
+// the in-memory one (little-endian, like the watch), so loading it is a
+// straight copy:
+//   header: 'R' 'P' version count rounds, 3 bytes padding
+//   count segments: end (ms from the start, u32) kind rounds_done, 2 bytes padding
+// Segments run from the previous one's end up to (not including) their
+// own. rounds_done is how many rounds have been finished by the time the
+// segment starts: a round is finished when the next work segment starts,
+// or when the program ends.
+#define PROGRAM_VERSION 1
+#define PROGRAM_MAX_SEGMENTS 64
+
+// Kinds are numbered like get_round_period()'s answers.
+#define PROGRAM_WORK 0
+#define PROGRAM_REST 2
+#define PROGRAM_WARMUP 3
+#define PROGRAM_COOLDOWN 4
+#define PROGRAM_DONE 5
+
+typedef struct {
+    uint8_t magic[2];
+    uint8_t version;
+    uint8_t count;
+    uint8_t rounds;
+    uint8_t padding[3];
+} ProgramHeader;
+
+typedef struct {
+    uint32_t end;
+    uint8_t kind;
+    uint8_t rounds_done;
+    uint16_t padding;
+} ProgramSegment;
+
+void program_load();
+bool program_loaded();
+int program_rounds();
+time_t program_length();
+time_t program_work(time_t elapsed);
+int program_segment(time_t elapsed);
+ProgramSegment *program_find(time_t elapsed);
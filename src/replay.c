@@ -0,0 +1,268 @@
+/*
+ * Pebble Round Timer - session record and replay
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "common.h"
+#include "config.h"
+#include "timers.h"
+#include "stats.h"
+#include "replay.h"
+
+#define REPLAY_COOKIE 0x4E91
+#define REPLAY_CHUNK 2000
+#define MAX_GAP 0xFFFF
+
+#define GAP(event) ((event) >> 16)
+#define KIND(event) (((event) >> 8) & 0xFF)
+#define ARG(event) ((event) & 0xFF)
+
+#if defined(ROUNDTIMER_RECORD) || defined(ROUNDTIMER_REPLAY)
+
+// Where the pebble clock was last corrected. It's anchored a millisecond
+// before the reading so a replay can put the correction in just ahead of
+// the wakeup that made it, and that wakeup still reads the same.
+static uint32_t anchor_at;
+static time_t anchor_seconds;
+
+static time_t clock_at(uint32_t at) {
+    return anchor_seconds + (time_t)((at - anchor_at) / 1000);
+}
+
+static void correct_clock(uint32_t at, time_t seconds) {
+    anchor_at = at - 1;
+    anchor_seconds = seconds;
+}
+
+#endif
+
+#ifdef ROUNDTIMER_RECORD
+
+// Time is the wheel's, which only moves when it wakes, so replaying an
+// event straight after the wakeup it followed puts everything back in
+// the state it was in. We stop when the buffer is full; a replay needs
+// to start from the beginning.
+static uint32_t events[REPLAY_SIZE];
+static int length = 0;
+static bool full = false;
+static uint32_t last_at = 0;
+static time_t first_seconds;
+static bool recording = false;
+static ClickHandler handlers[REPLAY_WINDOWS][NUM_BUTTONS][2];
+
+static bool push(uint32_t event) {
+    if(length == REPLAY_SIZE) {
+        full = true;
+        return false;
+    }
+    events[length++] = event;
+    return true;
+}
+
+static void record(uint8_t kind, uint8_t arg) {
+    uint32_t now = timers_now();
+    uint32_t gap = now - last_at;
+    for(; gap > MAX_GAP; gap -= MAX_GAP) {
+        if(!push(REPLAY_EVENT(MAX_GAP, REPLAY_GAP, 0))) return;
+    }
+    if(push(REPLAY_EVENT(gap, kind, arg))) last_at = now;
+}
+
+void replay_record_start() {
+    last_at = timers_now();
+    first_seconds = get_pebble_seconds();
+    correct_clock(last_at, first_seconds);
+    recording = true;
+}
+
+// Most seconds come when the wheel says they should; only the rest are
+// kept, so the buffer lasts as long as the clicks do.
+void replay_record_seconds(time_t seconds) {
+    if(!recording || full) return;
+    uint32_t now = timers_now();
+    time_t delta = seconds - clock_at(now);
+    if(!delta) return;
+    correct_clock(now, seconds);
+    while(delta) {
+        int8_t step = delta > 127 ? 127 : delta < -127 ? -127 : delta;
+        record(REPLAY_CLOCK, (uint8_t)step);
+        delta -= step;
+    }
+}
+
+// BACK on the main window is the system's, not ours to wrap, so what we
+// see is the window underneath coming back.
+void replay_record_appear(int window) {
+    if(recording && !full) record(REPLAY_APPEAR, window);
+}
+
+static void record_press(ClickRecognizerRef recognizer, void *context, int press) {
+    int window = context == &main_window ? REPLAY_MAIN_WINDOW : REPLAY_CONFIG_WINDOW;
+    ButtonId button = click_recognizer_get_button_id(recognizer);
+    if(!full) record(REPLAY_CLICK, window << 4 | button << 1 | press);
+    handlers[window][button][press](recognizer, context);
+}
+
+static void record_click(ClickRecognizerRef recognizer, void *context) {
+    record_press(recognizer, context, 0);
+}
+
+static void record_long_click(ClickRecognizerRef recognizer, void *context) {
+    record_press(recognizer, context, 1);
+}
+
+// Called at the end of a click config provider: note what it set up and
+// put ourselves in front of it.
+void replay_wrap_clicks(int window, ClickConfig **config) {
+    for(int button = 0; button < NUM_BUTTONS; ++button) {
+        if(config[button]->click.handler) {
+            handlers[window][button][0] = config[button]->click.handler;
+            config[button]->click.handler = record_click;
+        }
+        if(config[button]->long_click.handler) {
+            handlers[window][button][1] = config[button]->long_click.handler;
+            config[button]->long_click.handler = record_long_click;
+        }
+    }
+}
+
+// A start line, then the events eight to a line in hex.
+void replay_log() {
+    APP_LOG(APP_LOG_LEVEL_INFO, "REPLAY start %ld %d%s", (long)first_seconds, length, full ? " full" : "");
+    for(int i = 0; i < length; i += 8) {
+        uint32_t *e = &events[i];
+        int n = length - i < 8 ? length - i : 8;
+        APP_LOG(APP_LOG_LEVEL_INFO, "REPLAY %08lx %08lx %08lx %08lx %08lx %08lx %08lx %08lx",
+            (unsigned long)e[0], (unsigned long)(n > 1 ? e[1] : 0), (unsigned long)(n > 2 ? e[2] : 0),
+            (unsigned long)(n > 3 ? e[3] : 0), (unsigned long)(n > 4 ? e[4] : 0), (unsigned long)(n > 5 ? e[5] : 0),
+            (unsigned long)(n > 6 ? e[6] : 0), (unsigned long)(n > 7 ? e[7] : 0));
+    }
+}
+
+#endif
+
+#ifdef ROUNDTIMER_REPLAY
+
+// Written by tools/replay_pack.py: replay_first_seconds and replay_events[].
+#include "replay_trace.inc"
+
+#define REPLAY_LENGTH (sizeof(replay_events) / sizeof(replay_events[0]))
+
+// As with the bench, the wheel is jumped from one deadline to the next
+// rather than waited on, and the pebble clock says what it said then.
+static AppContextRef replay_app;
+static unsigned int next_event = 0;
+static uint32_t next_at;
+static ClickHandler handlers[REPLAY_WINDOWS][NUM_BUTTONS][2];
+
+static time_t replay_seconds() {
+    return clock_at(timers_now());
+}
+
+static void capture_clicks(int window, ClickConfigProvider provider) {
+    ClickConfig configs[NUM_BUTTONS];
+    ClickConfig *config[NUM_BUTTONS];
+    memset(configs, 0, sizeof(configs));
+    for(int button = 0; button < NUM_BUTTONS; ++button) config[button] = &configs[button];
+    provider(config, NULL);
+    for(int button = 0; button < NUM_BUTTONS; ++button) {
+        handlers[window][button][0] = configs[button].click.handler;
+        handlers[window][button][1] = configs[button].long_click.handler;
+    }
+}
+
+// Runs the wheel up to target, one wakeup at a time.
+static void run_until(uint32_t target) {
+    while((int32_t)(target - timers_now()) > 0) {
+        uint32_t due = timers_until_next();
+        if(due <= target - timers_now()) {
+            timers_fast_forward(due);
+            STAT_INC(STAT_WAKEUPS);
+            STATS_FRAME_END();
+        } else {
+            timers_fast_forward(target - timers_now());
+        }
+    }
+}
+
+static bool replay_chunk() {
+    for(int step = 0; step < REPLAY_CHUNK; ++step) {
+        if(next_event == REPLAY_LENGTH) return false;
+        uint32_t event = replay_events[next_event++];
+        next_at += GAP(event);
+        switch(KIND(event)) {
+            case REPLAY_CLOCK:
+                // It was read as the wheel woke at next_at, so change it just before.
+                if((int32_t)(next_at - 1 - timers_now()) > 0) run_until(next_at - 1);
+                correct_clock(next_at, clock_at(next_at) + (int8_t)ARG(event));
+                break;
+            case REPLAY_CLICK: {
+                run_until(next_at);
+                // Whatever the handler read of the clock was recorded after it.
+                while(next_event < REPLAY_LENGTH && GAP(replay_events[next_event]) == 0 &&
+                      KIND(replay_events[next_event]) == REPLAY_CLOCK) {
+                    correct_clock(next_at, clock_at(next_at) + (int8_t)ARG(replay_events[next_event++]));
+                }
+                ClickHandler handler = handlers[ARG(event) >> 4][(ARG(event) >> 1) & 7][ARG(event) & 1];
+                if(handler) handler(NULL, NULL);
+                STATS_FRAME_END();
+                break;
+            }
+            case REPLAY_APPEAR:
+                run_until(next_at);
+                // Only the config window comes back, when BACK takes the main one away.
+                if(ARG(event) == REPLAY_CONFIG_WINDOW && window_stack_get_top_window() == &main_window) {
+                    window_stack_pop(false);
+                }
+                STATS_FRAME_END();
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+void replay_start(AppContextRef ctx) {
+    replay_app = ctx;
+    capture_clicks(REPLAY_MAIN_WINDOW, (ClickConfigProvider)main_config_provider);
+    capture_clicks(REPLAY_CONFIG_WINDOW, (ClickConfigProvider)config_config_provider);
+    next_at = timers_now();
+    correct_clock(next_at, replay_first_seconds);
+    set_pebble_seconds_source(replay_seconds);
+    app_timer_send_event(replay_app, 1, REPLAY_COOKIE);
+}
+
+void replay_handle_event(AppContextRef ctx, AppTimerHandle handle, uint32_t cookie) {
+    if(cookie != REPLAY_COOKIE) return;
+    if(replay_chunk()) {
+        app_timer_send_event(replay_app, 1, REPLAY_COOKIE);
+        return;
+    }
+    APP_LOG(APP_LOG_LEVEL_INFO, "{\"replay\":\"done\",\"events\":%u,\"wheel_ms\":%lu}", (unsigned)REPLAY_LENGTH,
+        (unsigned long)timers_now());
+    STATS_LOG_SUMMARY();
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Pebble Round Timer - session record and replay header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+// Uncomment the first to keep a log of button presses, window changes and
+// pebble clock corrections in RAM, written to the app log on exit. tools/replay_pack.py
+// turns that log into src/replay_trace.inc; build with the second instead
+// and the app plays it back at simulated time when it starts, through the
+// same handlers, so what happened on a wrist can be profiled on a desk.
+// Add ROUNDTIMER_STATS to the replay build to get the usual summary.
+//#define ROUNDTIMER_RECORD
+//#define ROUNDTIMER_REPLAY
+
+// Events are packed into a word each: milliseconds of wheel time since
+// the previous event, what happened and a byte to say how. The pebble
+// clock is taken to count on a second per 1000 ms of wheel time from its
+// last correction, so only the readings that disagree are kept.
+#define REPLAY_SIZE 1024
+#define REPLAY_GAP 0 // nothing, the time between events was too long for one
+#define REPLAY_CLOCK 1 // the pebble clock was (signed) arg seconds off its count
+#define REPLAY_CLICK 2 // arg = window << 4 | button << 1 | long click
+#define REPLAY_APPEAR 3 // arg = window that came back on top, e.g. after BACK
+#define REPLAY_EVENT(gap, kind, arg) ((uint32_t)(gap) << 16 | (kind) << 8 | (arg))
+
+#define REPLAY_MAIN_WINDOW 0
+#define REPLAY_CONFIG_WINDOW 1
+#define REPLAY_WINDOWS 2
+
+#if defined(ROUNDTIMER_RECORD) && defined(ROUNDTIMER_REPLAY)
+#error Record or replay, not both
+#endif
+
+#ifdef ROUNDTIMER_RECORD
+
+void replay_record_start();
+void replay_record_seconds(time_t seconds);
+void replay_wrap_clicks(int window, ClickConfig **config);
+void replay_record_appear(int window);
+void replay_log();
+
+#define REPLAY_START(ctx) replay_record_start()
+#define REPLAY_SECONDS(seconds) replay_record_seconds(seconds)
+#define REPLAY_CLICKS(window, config) replay_wrap_clicks(window, config)
+#define REPLAY_APPEARED(window) replay_record_appear(window)
+#define REPLAY_LOG() replay_log()
+#define REPLAY_HANDLE_EVENT(ctx, handle, cookie)
+
+#elif defined(ROUNDTIMER_REPLAY)
+
+void replay_start(AppContextRef ctx);
+void replay_handle_event(AppContextRef ctx, AppTimerHandle handle, uint32_t cookie);
+
+#define REPLAY_START(ctx) replay_start(ctx)
+#define REPLAY_SECONDS(seconds)
+#define REPLAY_CLICKS(window, config)
+#define REPLAY_APPEARED(window)
+#define REPLAY_LOG()
+#define REPLAY_HANDLE_EVENT(ctx, handle, cookie) replay_handle_event(ctx, handle, cookie)
+
+#else
+
+#define REPLAY_START(ctx)
+#define REPLAY_SECONDS(seconds)
+#define REPLAY_CLICKS(window, config)
+#define REPLAY_APPEARED(window)
+#define REPLAY_LOG()
+#define REPLAY_HANDLE_EVENT(ctx, handle, cookie)
+
+#endif
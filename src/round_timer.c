@@ -0,0 +1,275 @@
+/*
+ * Pebble Round Timer - round timer instances
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "common.h"
+#include "timers.h"
+#include "clock.h"
+#include "session.h"
+#include "round_timer.h"
+#include "program.h"
+
+// Every round timer reads the shared clock, so a running timer costs
+// nothing per tick. The only work a timer that isn't on screen ever
+// needs is at its period boundaries, and each one keeps a wheel timer
+// for exactly that.
+
+#define FIRST_CHECK_DELAY 100
+
+RoundTimer round_timers[ROUND_TIMER_COUNT];
+static RoundTimerHandler on_boundary;
+
+static void schedule_boundary(RoundTimer *timer, time_t limit) {
+    time_t delay = time_to_next_boundary(round_timer_elapsed(timer));
+    if(limit && (!delay || delay > limit)) delay = limit;
+    if(delay) timer_schedule(&timer->boundary_timer, delay);
+    else timer_cancel(&timer->boundary_timer);
+}
+
+static void handle_boundary(void *data) {
+    RoundTimer *timer = data;
+    round_timers_sync();
+    time_t elapsed = round_timer_elapsed(timer);
+    session_round(&timer->session, current_round_count(elapsed), elapsed);
+    on_boundary(timer);
+    // We may have woken a little early if the clock was pulled back;
+    // the next boundary is then simply the one we were waiting for.
+    if(timer->started) schedule_boundary(timer, 0);
+}
+
+void round_timers_init(RoundTimerHandler boundary_handler) {
+    on_boundary = boundary_handler;
+    for(int i = 0; i < ROUND_TIMER_COUNT; ++i) {
+        timer_init(&round_timers[i].boundary_timer, handle_boundary, &round_timers[i]);
+        round_timer_reset(&round_timers[i]);
+    }
+}
+
+bool round_timers_running() {
+    for(int i = 0; i < ROUND_TIMER_COUNT; ++i) {
+        if(round_timers[i].started) return true;
+    }
+    return false;
+}
+
+// Keeps the clock in step, bringing along any run or pause that was
+// anchored while it was still settling after a resume.
+void round_timers_sync() {
+    time_t since;
+    bool moved;
+    time_t correction = clock_sync(&since, &moved);
+    for(int i = 0; correction && i < ROUND_TIMER_COUNT; ++i) {
+        RoundTimer *timer = &round_timers[i];
+        if(timer->started && timer->resumed_at >= since) {
+            timer->resumed_at += correction;
+            if(timer->elapsed) timer->paused += correction;
+        } else if(!timer->started && timer->elapsed && timer->paused_at >= since) {
+            timer->paused_at += correction;
+        }
+    }
+    // Boundaries were worked out on the clock as it was, so any that are
+    // waiting get worked out again. One still waiting on its first check
+    // after a start keeps it; that's at most a tick away.
+    for(int i = 0; moved && i < ROUND_TIMER_COUNT; ++i) {
+        RoundTimer *timer = &round_timers[i];
+        if(timer->started && timer->last_period != -1 && timer_is_pending(&timer->boundary_timer)) {
+            schedule_boundary(timer, 0);
+        }
+    }
+}
+
+// Starts and stops are put between wakeups (see clock_between()), so
+// until the next one the clock can still be short of them.
+time_t round_timer_elapsed(RoundTimer *timer) {
+    if(!timer->started) return timer->elapsed;
+    time_t now = clock_now();
+    return timer->elapsed + (now > timer->resumed_at ? now - timer->resumed_at : 0);
+}
+
+// Time spent paused, not counting before the first start.
+time_t round_timer_paused(RoundTimer *timer) {
+    if(timer->started || !timer->elapsed) return timer->paused;
+    time_t now = clock_now();
+    return timer->paused + (now > timer->paused_at ? now - timer->paused_at : 0);
+}
+
+void round_timer_start(RoundTimer *timer) {
+    if(timer->started) return;
+    if(!timer->elapsed) session_begin(&timer->session);
+    timer->started = true;
+    timer->resumed_at = clock_between();
+    if(timer->elapsed && timer->resumed_at < timer->paused_at) timer->resumed_at = timer->paused_at;
+    if(timer->elapsed) timer->paused += timer->resumed_at - timer->paused_at;
+    // Look at the period we're starting in after the first tick, like we always have.
+    schedule_boundary(timer, FIRST_CHECK_DELAY);
+}
+
+void round_timer_stop(RoundTimer *timer) {
+    if(!timer->started) return;
+    // Elapsed and paused both come off this one reading, so between them
+    // they always add up to the time since the first start.
+    time_t now = clock_between();
+    if(now < timer->resumed_at) now = timer->resumed_at;
+    timer->elapsed += now - timer->resumed_at;
+    timer->started = false;
+    timer->paused_at = now;
+    timer_cancel(&timer->boundary_timer);
+}
+
+void round_timer_reset(RoundTimer *timer) {
+    round_timer_stop(timer);
+    if(timer->elapsed) session_finish(&timer->session, timer->elapsed, timer->paused);
+    timer->elapsed = 0;
+    timer->paused = 0;
+    timer->last_period = -1;
+    timer->last_segment = -1;
+    timer->last_lap_time = 0;
+}
+
+#ifdef ROUNDTIMER_VERIFY_SCHEDULE
+// The original loops, kept to check the arithmetic below against.
+static time_t reference_running_time(time_t elapsed) {
+    time_t running_time = elapsed;
+    time_t full_round = round_time + rest_time;
+    if (full_round <= 0) return elapsed; // would never finish
+    for (; running_time > full_round; running_time -= full_round);
+
+    return running_time;
+}
+
+static int reference_round_count(time_t elapsed) {
+    time_t running_time = elapsed;
+    time_t full_round = round_time + rest_time;
+    int round_counter = 0;
+    if (full_round <= 0) return 0;
+    for (; running_time > full_round; running_time -= full_round) round_counter++;
+
+    return round_counter;
+}
+
+#define VERIFY_SCHEDULE(name, elapsed, got, expected) \
+    if((got) != (expected)) APP_LOG(APP_LOG_LEVEL_ERROR, "%s(%ld) %ld != %ld", name, (long)(elapsed), (long)(got), (long)(expected))
+#else
+#define VERIFY_SCHEDULE(name, elapsed, got, expected)
+#endif
+
+// A running time exactly on a round boundary still belongs to the round
+// that's ending, hence the -1/+1. With no round or rest time at all the
+// loops never finished; now the elapsed time just comes back unchanged.
+time_t single_round_running_time(time_t elapsed) {
+    time_t running_time = elapsed;
+    time_t full_round = round_time + rest_time;
+    if (full_round > 0 && running_time > full_round) {
+        running_time = (running_time - 1) % full_round + 1;
+    }
+
+    VERIFY_SCHEDULE("running_time", elapsed, running_time, reference_running_time(elapsed));
+    return running_time;
+}
+
+int get_round_period(time_t elapsed) {
+    // If we are within a round period: 0
+    // If we are within a warning period: 1
+    // If we are within a resting period: 2
+    // Programs can also be warming up (3), cooling down (4) or done (5).
+
+    if (program_loaded()) {
+        ProgramSegment *segment = program_find(elapsed);
+        if (!segment) return PROGRAM_DONE;
+        if (segment->kind == PROGRAM_WORK && warning_time != 0 && elapsed > (time_t)segment->end - warning_time) {
+            return 1;
+        }
+        return segment->kind;
+    }
+
+    time_t running_time = single_round_running_time(elapsed);
+
+    if (running_time < round_time) {
+        if (warning_time != 0 && running_time > round_time - warning_time) {
+            return 1;
+        }
+        return 0;
+    }
+    return 2;
+}
+
+time_t current_counter(time_t elapsed) {
+    if (program_loaded()) {
+        ProgramSegment *segment = program_find(elapsed);
+        return segment ? (time_t)segment->end - elapsed : 0;
+    }
+
+    time_t running_time = single_round_running_time(elapsed);
+
+    if (running_time < round_time) {
+        return round_time - running_time;
+    }
+    running_time -= round_time;
+    return rest_time - running_time;
+}
+
+int current_round_count(time_t elapsed) {
+    if (program_loaded()) {
+        ProgramSegment *segment = program_find(elapsed);
+        return segment ? segment->rounds_done : program_rounds();
+    }
+
+    time_t full_round = round_time + rest_time;
+    int round_counter = 0;
+    if (full_round > 0 && elapsed > full_round) {
+        round_counter = (elapsed - 1) / full_round;
+    }
+
+    VERIFY_SCHEDULE("round_count", elapsed, round_counter, reference_round_count(elapsed));
+    return round_counter;
+}
+
+// How long until get_round_period() next changes its answer, or 0 if it never will.
+// Periods flip when the running time first passes round - warning, when it
+// reaches the end of the round, and when it wraps past a full round.
+time_t time_to_next_boundary(time_t elapsed) {
+    if (program_loaded()) {
+        ProgramSegment *segment = program_find(elapsed);
+        if (!segment) return 0;
+        time_t warning_start = (time_t)segment->end - warning_time + 1;
+        if (segment->kind == PROGRAM_WORK && warning_time != 0 && warning_start > elapsed) {
+            return warning_start - elapsed;
+        }
+        return segment->end - elapsed;
+    }
+
+    time_t full_round = round_time + rest_time;
+    if (full_round <= 0) return 0;
+
+    time_t running_time = single_round_running_time(elapsed);
+    time_t next = full_round + 1;
+    time_t warning_start = round_time - warning_time + 1;
+    if (warning_time != 0 && warning_start > running_time && warning_start < next) {
+        next = warning_start;
+    }
+    if (round_time > running_time && round_time < next) {
+        next = round_time;
+    }
+    return next - running_time;
+}
@@ -0,0 +1,61 @@
+/*
+ * Pebble Round Timer - round timer instances header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+// Uncomment to check the schedule arithmetic against the original loops
+// on every call, logging any disagreement. tools/schedule_sweep.py does
+// the same on the host for every setting the config screen allows.
+//#define ROUNDTIMER_VERIFY_SCHEDULE
+
+#define ROUND_TIMER_COUNT 4
+
+typedef struct RoundTimer {
+    bool started;
+    time_t elapsed; // banked time from previous runs
+    time_t resumed_at; // clock time the current run started at
+    time_t paused; // banked time spent paused between runs
+    time_t paused_at; // clock time the current pause started at
+    int last_period;
+    int last_segment; // program segment last signalled, -1 without a program
+    time_t last_lap_time;
+    SessionRecord session;
+    Timer boundary_timer;
+} RoundTimer;
+
+typedef void (*RoundTimerHandler)(RoundTimer *timer);
+
+extern RoundTimer round_timers[ROUND_TIMER_COUNT];
+
+void round_timers_init(RoundTimerHandler boundary_handler);
+bool round_timers_running();
+void round_timers_sync();
+time_t round_timer_elapsed(RoundTimer *timer);
+time_t round_timer_paused(RoundTimer *timer);
+void round_timer_start(RoundTimer *timer);
+void round_timer_stop(RoundTimer *timer);
+void round_timer_reset(RoundTimer *timer);
+
+time_t single_round_running_time(time_t elapsed);
+int get_round_period(time_t elapsed);
+time_t current_counter(time_t elapsed);
+int current_round_count(time_t elapsed);
+time_t time_to_next_boundary(time_t elapsed);
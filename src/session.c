@@ -0,0 +1,86 @@
+/*
+ * Pebble Round Timer - session records
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "common.h"
+#include "timers.h"
+#include "session.h"
+#include "round_timer.h"
+#include "program.h"
+#include "export.h"
+#include "history.h"
+
+#define TENTHS(ms) ((ms) / 100)
+
+void session_begin(SessionRecord *session) {
+    session->start = get_pebble_seconds();
+    session->program = program_loaded();
+    session->round_seconds = session->program ? 0 : round_time / 1000;
+    session->warning_seconds = warning_time / 1000;
+    session->rest_seconds = session->program ? 0 : rest_time / 1000;
+    session->round_count = session->program ? program_rounds() : total_round_count;
+    session->lap_count = 0;
+    session->rounds_done = 0;
+    session->best_round = SESSION_NO_ROUND;
+    session->round_began = 0;
+}
+
+void session_lap(SessionRecord *session, time_t lap_time) {
+    if(session->lap_count >= SESSION_MAX_LAPS) return;
+    time_t tenths = TENTHS(lap_time);
+    session->laps[session->lap_count++] = tenths > 0xFFFF ? 0xFFFF : tenths;
+}
+
+// Called at every period boundary. A round is timed on the timer's own
+// elapsed time, so pauses don't make it look slower; with a program the
+// rounds aren't all the same length. If we somehow missed a round
+// ending, we can't say how long either took.
+void session_round(SessionRecord *session, int rounds_done, time_t elapsed) {
+    if(rounds_done <= session->rounds_done) return;
+    if(rounds_done == session->rounds_done + 1) {
+        time_t tenths = TENTHS(elapsed - session->round_began);
+        if(tenths < session->best_round) session->best_round = tenths;
+    }
+    session->rounds_done = rounds_done;
+    session->round_began = elapsed;
+}
+
+void session_finish(SessionRecord *session, time_t elapsed, time_t paused) {
+    session->rounds_done = current_round_count(elapsed);
+    session->elapsed = TENTHS(elapsed);
+    session->paused = TENTHS(paused);
+    if(session->program) {
+        session->work = TENTHS(program_work(elapsed));
+    } else {
+        // Every finished round is all work then all rest; the one in
+        // progress is work until the round time is up.
+        uint32_t round = session->round_seconds * 10;
+        uint32_t full_round = round + session->rest_seconds * 10;
+        uint32_t done = session->rounds_done * full_round;
+        uint32_t remainder = session->elapsed > done ? session->elapsed - done : 0;
+        session->work = session->rounds_done * round + (remainder < round ? remainder : round);
+    }
+    history_add(session);
+    export_queue(session);
+}
@@ -0,0 +1,51 @@
+/*
+ * Pebble Round Timer - session records header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#define SESSION_MAX_LAPS 28
+#define SESSION_NO_ROUND 0xFFFF
+
+// Everything worth keeping about one session, from the first start of a
+// round timer to its reset. Times are in tenths of a second. When a
+// program set the schedule, round and rest are 0 and round_count is the
+// program's; the warning still applies to its work segments.
+typedef struct {
+    uint32_t start; // seconds on the pebble clock
+    bool program;
+    uint16_t round_seconds;
+    uint16_t warning_seconds;
+    uint16_t rest_seconds;
+    uint8_t round_count;
+    uint8_t rounds_done;
+    uint32_t elapsed;
+    uint32_t paused;
+    uint32_t work; // how much of elapsed was work rather than rest
+    uint8_t lap_count;
+    uint16_t laps[SESSION_MAX_LAPS];
+    uint16_t best_round; // quickest round start to finish, pauses left out
+    time_t round_began; // elapsed time the current round started at
+} SessionRecord;
+
+void session_begin(SessionRecord *session);
+void session_lap(SessionRecord *session, time_t lap_time);
+void session_round(SessionRecord *session, int rounds_done, time_t elapsed);
+void session_finish(SessionRecord *session, time_t elapsed, time_t paused);
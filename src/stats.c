@@ -0,0 +1,178 @@
+/*
+ * Pebble Round Timer - hot path statistics
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "stats.h"
+
+#ifdef ROUNDTIMER_STATS
+
+// The Cortex-M3's cycle counter. The SDK doesn't offer anything finer
+// than a second, so this is the only way to time a tick.
+#define DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+
+static const char *counter_names[STAT_COUNT] = {
+    "wakeups", "ticks", "set_text", "invalidations", "animations", "skipped_animations", "vibes", "vibe_ms", "resyncs", "max_correction",
+    "max_phase_error", "frames", "dirty_rects", "pixels", "max_frame_pixels", "glyphs",
+    "saved_frames", "max_stack", "export_drops"
+};
+#ifdef ROUNDTIMER_STATS_CYCLES
+static const char *timer_names[STAT_TIME_COUNT] = {
+    "wheel", "tick", "update"
+};
+#endif
+
+static uint32_t counters[STAT_COUNT];
+static uint32_t timed_calls[STAT_TIME_COUNT];
+static uint32_t total_cycles[STAT_TIME_COUNT];
+static uint32_t max_cycles[STAT_TIME_COUNT];
+static uint32_t frame_pixels = 0;
+
+// The stack grows down from wherever stats_init was called. We fill the
+// probe below that with a pattern and see how much of it got written over.
+#define STACK_PAINT 0xA5A5A5A5
+static volatile uint32_t *stack_top;
+
+#define SCREEN_WIDTH 144
+#define SCREEN_HEIGHT 168
+
+static void __attribute__((noinline)) stack_paint() {
+    volatile uint32_t here = 0;
+    // Leave our own frame and whatever is live above it alone.
+    volatile uint32_t *p = &here - 8;
+    for(; p >= stack_top - STATS_STACK_PROBE / 4; --p) *p = STACK_PAINT;
+}
+
+// Bytes used below stats_init's caller. The whole probe means it overflowed.
+static uint32_t stack_used() {
+    volatile uint32_t *p = stack_top - STATS_STACK_PROBE / 4;
+    while(p < stack_top && *p == STACK_PAINT) ++p;
+    return (stack_top - p) * sizeof(uint32_t);
+}
+
+void stats_init() {
+    volatile uint32_t top = 0;
+    stack_top = &top;
+    stack_paint();
+#ifdef ROUNDTIMER_STATS_CYCLES
+    DEMCR |= 1 << 24;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= 1;
+#endif
+}
+
+void stats_reset() {
+    memset(counters, 0, sizeof(counters));
+    memset(timed_calls, 0, sizeof(timed_calls));
+    memset(total_cycles, 0, sizeof(total_cycles));
+    memset(max_cycles, 0, sizeof(max_cycles));
+    frame_pixels = 0;
+    stack_paint();
+}
+
+void stats_count(StatCounter counter) {
+    ++counters[counter];
+}
+
+void stats_max(StatCounter counter, uint32_t value) {
+    if(value > counters[counter]) counters[counter] = value;
+}
+
+void stats_time(StatTimer timer, uint32_t cycles) {
+    ++timed_calls[timer];
+    total_cycles[timer] += cycles;
+    if(cycles > max_cycles[timer]) max_cycles[timer] = cycles;
+}
+
+// Draw cost. We can't see the framebuffer, so this is what we asked the
+// system to redraw: each invalidated layer's frame clipped to the screen,
+// plus one glyph per character of any new text. Our layers all sit right
+// on their window's root layer, so frames are already in screen terms.
+// tools/render_test.py draws the frames on the host for the real count.
+void stats_dirty(Layer *layer) {
+    GRect frame = layer_get_frame(layer);
+    int x0 = frame.origin.x < 0 ? 0 : frame.origin.x;
+    int y0 = frame.origin.y < 0 ? 0 : frame.origin.y;
+    int x1 = frame.origin.x + frame.size.w > SCREEN_WIDTH ? SCREEN_WIDTH : frame.origin.x + frame.size.w;
+    int y1 = frame.origin.y + frame.size.h > SCREEN_HEIGHT ? SCREEN_HEIGHT : frame.origin.y + frame.size.h;
+    ++counters[STAT_INVALIDATIONS];
+    if(x1 <= x0 || y1 <= y0) return;
+    ++counters[STAT_DIRTY_RECTS];
+    frame_pixels += (x1 - x0) * (y1 - y0);
+}
+
+void stats_text(TextLayer *layer, const char *text) {
+    ++counters[STAT_SET_TEXT];
+    counters[STAT_GLYPHS] += strlen(text);
+    stats_dirty(&layer->layer);
+}
+
+void stats_line(GPoint p0, GPoint p1) {
+    int dx = p1.x > p0.x ? p1.x - p0.x : p0.x - p1.x;
+    int dy = p1.y > p0.y ? p1.y - p0.y : p0.y - p1.y;
+    frame_pixels += (dx > dy ? dx : dy) + 1;
+}
+
+void stats_vibe(uint32_t ms) {
+    ++counters[STAT_VIBES];
+    counters[STAT_VIBE_MS] += ms;
+}
+
+// Patterns alternate on and off, starting with on.
+void stats_vibe_pattern(VibePattern pattern) {
+    uint32_t ms = 0;
+    for(uint32_t i = 0; i < pattern.num_segments; i += 2) ms += pattern.durations[i];
+    stats_vibe(ms);
+}
+
+// The system draws once we hand control back, so every event we handle is a frame.
+void stats_frame_end() {
+    if(!frame_pixels) return;
+    ++counters[STAT_FRAMES];
+    counters[STAT_PIXELS] += frame_pixels;
+    stats_max(STAT_MAX_FRAME_PIXELS, frame_pixels);
+    frame_pixels = 0;
+}
+
+uint32_t stats_cycles() {
+    return DWT_CYCCNT;
+}
+
+// One JSON object per line so the log can be picked apart by a script.
+void stats_log_summary() {
+    stats_max(STAT_MAX_STACK, stack_used());
+    for(int i = 0; i < STAT_COUNT; ++i) {
+        APP_LOG(APP_LOG_LEVEL_INFO, "{\"stat\":\"%s\",\"value\":%lu}", counter_names[i], (unsigned long)counters[i]);
+    }
+#ifdef ROUNDTIMER_STATS_CYCLES
+    for(int i = 0; i < STAT_TIME_COUNT; ++i) {
+        APP_LOG(APP_LOG_LEVEL_INFO, "{\"time\":\"%s\",\"calls\":%lu,\"cycles\":%lu,\"max\":%lu}", timer_names[i],
+            (unsigned long)timed_calls[i], (unsigned long)total_cycles[i], (unsigned long)max_cycles[i]);
+    }
+#endif
+}
+
+#endif
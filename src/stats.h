@@ -0,0 +1,119 @@
+/*
+ * Pebble Round Timer - hot path statistics header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+// Uncomment to count what the hot paths cost. The totals go to the app
+// log when the app exits. The second one also times them in CPU cycles.
+//#define ROUNDTIMER_STATS
+//#define ROUNDTIMER_STATS_CYCLES
+
+typedef enum {
+    STAT_WAKEUPS = 0,
+    STAT_TICKS,
+    STAT_SET_TEXT,
+    STAT_INVALIDATIONS,
+    STAT_ANIMATIONS,
+    STAT_SKIPPED_ANIMATIONS,
+    STAT_VIBES,
+    STAT_VIBE_MS,
+    STAT_RESYNCS,
+    STAT_MAX_CORRECTION,
+    STAT_MAX_PHASE_ERROR,
+    STAT_FRAMES,
+    STAT_DIRTY_RECTS,
+    STAT_PIXELS,
+    STAT_MAX_FRAME_PIXELS,
+    STAT_GLYPHS,
+    STAT_SAVED_FRAMES,
+    STAT_MAX_STACK,
+    STAT_EXPORT_DROPS,
+    STAT_COUNT
+} StatCounter;
+
+typedef enum {
+    STAT_TIME_WHEEL = 0,
+    STAT_TIME_TICK,
+    STAT_TIME_UPDATE,
+    STAT_TIME_COUNT
+} StatTimer;
+
+#ifdef ROUNDTIMER_STATS
+
+// How long the system's own pulses run the motor, roughly.
+#define VIBE_LONG_MS 500
+#define VIBE_SHORT_MS 100
+
+// How far below handle_init we paint the stack to find its high-water
+// mark. The firmware doesn't tell an app where its stack ends, and past
+// it is memory that isn't ours. The smallest app stack Pebble has quoted
+// is 2 KB, and pbl_main and the event loop already sit above handle_init.
+// A quarter of that stays clear of the end with room to spare.
+#define STATS_STACK_PROBE 512
+
+void stats_init();
+void stats_reset();
+void stats_count(StatCounter counter);
+void stats_max(StatCounter counter, uint32_t value);
+void stats_time(StatTimer timer, uint32_t cycles);
+void stats_text(TextLayer *layer, const char *text);
+void stats_dirty(Layer *layer);
+void stats_line(GPoint p0, GPoint p1);
+void stats_vibe(uint32_t ms);
+void stats_vibe_pattern(VibePattern pattern);
+void stats_frame_end();
+uint32_t stats_cycles();
+void stats_log_summary();
+
+#define STATS_INIT() stats_init()
+#define STATS_RESET() stats_reset()
+#define STAT_INC(counter) stats_count(counter)
+#define STAT_MAX(counter, value) stats_max(counter, value)
+#define STATS_LOG_SUMMARY() stats_log_summary()
+#define STATS_FRAME_END() stats_frame_end()
+
+// Count the SDK calls we care about wherever this header is included.
+#define text_layer_set_text(layer, text) (stats_text(layer, text), text_layer_set_text(layer, text))
+#define layer_mark_dirty(layer) (stats_dirty(layer), layer_mark_dirty(layer))
+#define graphics_draw_line(ctx, p0, p1) (stats_line(p0, p1), graphics_draw_line(ctx, p0, p1))
+#define animation_schedule(animation) (stats_count(STAT_ANIMATIONS), animation_schedule(animation))
+#define vibes_long_pulse() (stats_vibe(VIBE_LONG_MS), vibes_long_pulse())
+#define vibes_double_pulse() (stats_vibe(2 * VIBE_SHORT_MS), vibes_double_pulse())
+#define vibes_enqueue_custom_pattern(pattern) (stats_vibe_pattern(pattern), vibes_enqueue_custom_pattern(pattern))
+
+#else
+
+#define STATS_INIT()
+#define STATS_RESET()
+#define STAT_INC(counter)
+#define STAT_MAX(counter, value)
+#define STATS_LOG_SUMMARY()
+#define STATS_FRAME_END()
+
+#endif
+
+#if defined(ROUNDTIMER_STATS) && defined(ROUNDTIMER_STATS_CYCLES)
+#define STAT_TIME_BEGIN(timer) uint32_t stat_started_##timer = stats_cycles()
+#define STAT_TIME_END(timer) stats_time(timer, stats_cycles() - stat_started_##timer)
+#else
+#define STAT_TIME_BEGIN(timer)
+#define STAT_TIME_END(timer)
+#endif
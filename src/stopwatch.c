@@ -28,6 +28,18 @@
 #include "laps.h"
 #include "config.h"
 #include "common.h"
+#include "timers.h"
+#include "clock.h"
+#include "session.h"
+#include "round_timer.h"
+#include "program.h"
+#include "deferred.h"
+#include "stats.h"
+#include "trace.h"
+#include "export.h"
+#include "bench.h"
+#include "replay.h"
+#include "history_view.h"
 
 #define MY_UUID { 0x58, 0x72, 0x50, 0x98, 0x05, 0x84, 0x49, 0xE3, 0xA1, 0x2D, 0xBE, 0x1A, 0x7C, 0xAF, 0x2B, 0x43 }
 PBL_APP_INFO(MY_UUID,
@@ -47,12 +59,17 @@ static TextLayer count_text_layer;
 static TextLayer count_layer;
 static TextLayer elapsed_layer;
 static TextLayer elapsed_text_layer;
+static TextLayer paused_layer;
+static TextLayer paused_text_layer;
+static TextLayer timer_number_layer;
 
-static char period_text[8] = "";
-static char new_period_text[8] = "";
+static char period_text[10] = "";
+static char new_period_text[10] = "";
 
 static char round_count_text[3] = "";
-static char elapsed_count_text[7] = "00:00.0";
+static char elapsed_count_text[8] = "00:00.0";
+static char paused_count_text[8] = "00:00.0";
+static char timer_number_text[3] = "T1";
 
 const VibePattern round_done_pattern = {
     .durations = (uint32_t []) {300, 100, 300, 100, 300},
@@ -69,33 +86,30 @@ const VibePattern all_rounds_done_pattern = {
 static char lap_times[LAP_TIME_SIZE][11] = {"00:00:00.0", "00:01:00.0", "00:02:00.0", "00:03:00.0", "00:04:00.0"};
 static TextLayer lap_layers[LAP_TIME_SIZE]; // an extra temporary layer
 static int next_lap_layer = 0;
-static int last_lap_time = 0;
-
-int last_period = -1;
-
-// The documentation claims this is defined, but it is not.
-// Define it here for now.
-#ifndef APP_TIMER_INVALID_HANDLE
-    #define APP_TIMER_INVALID_HANDLE 0xDEADBEEF
-#endif
-
-// Actually keeping track of time
-static time_t elapsed_time = 0;
-static bool started = false;
-static AppTimerHandle update_timer = APP_TIMER_INVALID_HANDLE;
-// We want hundredths of a second, but Pebble won't give us that.
-// Pebble's timers are also too inaccurate (we run fast for some reason)
-// Instead, we count our own time but also adjust ourselves every pebble
-// clock tick. We maintain our original offset in hundredths of a second
-// from the first tick. This should ensure that we always have accurate times.
-static time_t start_time = 0;
-static time_t last_pebble_time = 0;
+
+// Actually keeping track of time. The round timers themselves live in
+// round_timer.c; this is the one we're showing, and the tick that keeps
+// the shared clock and the display up to date while any of them run.
+static int shown_timer = 0;
+static Timer update_timer;
+// When the tick was due on the clock, for the trace.
+static time_t tick_due = 0;
+// Which timers a reset was asked for, decided when UP was pressed since
+// DOWN can change the shown timer before the queue drains.
+static uint8_t timers_to_reset = 0;
 
 // Global animation lock. As long as we only try doing things while
 // this is zero, we shouldn't crash the watch.
 static int busy_animating = 0;
 
-#define TIMER_UPDATE 1
+// Anything moving redraws the window every frame anyway, so while it does
+// the tick just updates its buffers in place and lets the animation draw
+// them. Whatever changed gets one redraw when the last animation stops.
+static int animations_running = 0;
+static TextLayer *paced_layers[] = {&big_time_layer, &seconds_time_layer, &elapsed_text_layer, &paused_text_layer, &count_layer};
+#define PACED_LAYER_COUNT (sizeof(paced_layers) / sizeof(paced_layers[0]))
+static bool paced_dirty[PACED_LAYER_COUNT];
+
 #define FONT_BIG_TIME RESOURCE_ID_FONT_DEJAVU_SANS_BOLD_SUBSET_30
 #define FONT_SECONDS RESOURCE_ID_FONT_DEJAVU_SANS_SUBSET_18
 #define FONT_LAPS RESOURCE_ID_FONT_DEJAVU_SANS_SUBSET_22
@@ -103,6 +117,9 @@ static int busy_animating = 0;
 #define BUTTON_LAP BUTTON_ID_DOWN
 #define BUTTON_RUN BUTTON_ID_SELECT
 #define BUTTON_RESET BUTTON_ID_UP
+#define BUTTON_NEXT_TIMER BUTTON_ID_DOWN
+
+#define current_timer() (&round_timers[shown_timer])
 
 void toggle_stopwatch_handler(ClickRecognizerRef recognizer, Window *window);
 void main_config_provider(ClickConfig **config, Window *window);
@@ -112,21 +129,39 @@ void stop_stopwatch();
 void start_stopwatch();
 void toggle_stopwatch_handler(ClickRecognizerRef recognizer, Window *window);
 void reset_stopwatch_handler(ClickRecognizerRef recognizer, Window *window);
+void next_timer_handler(ClickRecognizerRef recognizer, Window *window);
+void reset_round_timer(RoundTimer *timer, bool keep_running);
 void update_stopwatch();
+bool paced_set_text(TextLayer *layer, const char *text);
+void animation_began();
+void animation_ended();
 void handle_timer(AppContextRef ctx, AppTimerHandle handle, uint32_t cookie);
+void handle_tick(void *data);
 void pbl_main(void *params);
 void draw_line(Layer *me, GContext* ctx);
 void save_lap_time(int seconds);
 void lap_time_handler(ClickRecognizerRef recognizer, Window *window);
+bool layer_on_screen(Layer *layer, GRect *from, GRect *to);
+void animate_lap_layer(PropertyAnimation* animation, Layer* layer, GRect* origin, GRect* target, int delay, AnimationCurve curve);
 void shift_lap_layer(PropertyAnimation* animation, Layer* layer, GRect* target, int distance_multiplier);
-time_t single_round_running_time();
-int get_round_period();
-time_t current_counter();
-void period_changed();
-int current_round_count();
+void period_changed(RoundTimer *timer);
+void display_new_period();
+void reset_all_work();
+void reset_timer_work();
+void show_timer_work();
 
 void handle_init(AppContextRef ctx) {
     app = ctx;
+    STATS_INIT();
+    timers_init(ctx);
+    timer_init(&update_timer, handle_tick, NULL);
+    round_timers_init(period_changed);
+    deferred_init();
+    export_init();
+    deferred_register(DEFER_RESET_ALL, reset_all_work);
+    deferred_register(DEFER_RESET_TIMER, reset_timer_work);
+    deferred_register(DEFER_SHOW_TIMER, show_timer_work);
+    deferred_register(DEFER_REDRAW, update_stopwatch);
 
     // Main window setup
     window_init(&main_window, "Round Timer");
@@ -136,6 +171,10 @@ void handle_init(AppContextRef ctx) {
 
     resource_init_current_app(&APP_RESOURCES);
 
+    // A compiled program, if there is one, decides the rounds.
+    program_load();
+    if(program_loaded()) total_round_count = program_rounds();
+
     // Arrange for user input.
     window_set_click_config_provider(&main_window, (ClickConfigProvider) main_config_provider);
 
@@ -203,6 +242,30 @@ void handle_init(AppContextRef ctx) {
     text_layer_set_text_alignment(&elapsed_text_layer, GTextAlignmentLeft);
     layer_add_child(root_layer, &elapsed_text_layer.layer);
 
+    text_layer_init(&timer_number_layer, GRect(96, 131, 48, 21));
+    text_layer_set_background_color(&timer_number_layer, GColorBlack);
+    text_layer_set_font(&timer_number_layer, seconds_font);
+    text_layer_set_text_color(&timer_number_layer, GColorWhite);
+    text_layer_set_text(&timer_number_layer, timer_number_text);
+    text_layer_set_text_alignment(&timer_number_layer, GTextAlignmentRight);
+    layer_add_child(root_layer, &timer_number_layer.layer);
+
+    text_layer_init(&paused_layer, GRect(0, 89, 51, 21));
+    text_layer_set_background_color(&paused_layer, GColorBlack);
+    text_layer_set_font(&paused_layer, seconds_font);
+    text_layer_set_text_color(&paused_layer, GColorWhite);
+    text_layer_set_text(&paused_layer, "Pause:");
+    text_layer_set_text_alignment(&paused_layer, GTextAlignmentLeft);
+    layer_add_child(root_layer, &paused_layer.layer);
+
+    text_layer_init(&paused_text_layer, GRect(51, 89, 67, 21));
+    text_layer_set_background_color(&paused_text_layer, GColorBlack);
+    text_layer_set_font(&paused_text_layer, seconds_font);
+    text_layer_set_text_color(&paused_text_layer, GColorWhite);
+    text_layer_set_text(&paused_text_layer, paused_count_text);
+    text_layer_set_text_alignment(&paused_text_layer, GTextAlignmentLeft);
+    layer_add_child(root_layer, &paused_text_layer.layer);
+
     // Set up the lap time layers. These will be made visible later.
     for(int i = 0; i < LAP_TIME_SIZE; ++i) {
         text_layer_init(&lap_layers[i], GRect(-139, -30, 139, 30));
@@ -219,10 +282,16 @@ void handle_init(AppContextRef ctx) {
     layer_add_child(root_layer, &button_labels.layer.layer);
 
     init_config_window();
+    init_history_window();
+    BENCH_START(ctx);
+    REPLAY_START(ctx);
 }
 
 void handle_deinit(AppContextRef ctx) {
     bmp_deinit_container(&button_labels);
+    STATS_LOG_SUMMARY();
+    TRACE_LOG();
+    REPLAY_LOG();
 }
 
 void draw_line(Layer *me, GContext* ctx) {
@@ -231,38 +300,44 @@ void draw_line(Layer *me, GContext* ctx) {
     graphics_draw_line(ctx, GPoint(0, 1), GPoint(140, 1));
 }
 
+static void schedule_tick(time_t delay) {
+    tick_due = clock_now() + delay;
+    timer_schedule(&update_timer, delay);
+}
+
 void stop_stopwatch() {
-    started = false;
-    if(update_timer != APP_TIMER_INVALID_HANDLE) {
-        if(app_timer_cancel_event(app, update_timer)) {
-            update_timer = APP_TIMER_INVALID_HANDLE;
-        }
-    }
+    round_timer_stop(current_timer());
+    if(!round_timers_running()) timer_cancel(&update_timer);
 }
 
 void start_stopwatch() {
-    started = true;
-    last_pebble_time = 0;
-    start_time = 0;
-    update_timer = app_timer_send_event(app, 100, TIMER_UPDATE);
+    if(!round_timers_running()) {
+        // Nothing was keeping the clock ticking, so bring it up to date.
+        clock_resume();
+        schedule_tick(100);
+    }
+    round_timer_start(current_timer());
 }
 
+// Starting and stopping happen right away since they're what we're timing.
+// Everything else a button does waits for the deferred queue.
 void toggle_stopwatch_handler(ClickRecognizerRef recognizer, Window *window) {
-    if(started) {
+    if(current_timer()->started) {
         stop_stopwatch();
+        deferred_post(DEFER_REDRAW);
     } else {
         start_stopwatch();
     }
 }
 
-void reset_stopwatch(bool keep_running) {
-    bool is_running = started;
-    stop_stopwatch();
-    elapsed_time = 0;
-    start_time = 0;
-    last_lap_time = 0;
-    last_pebble_time = 0;
-    last_period = -1;
+void reset_round_timer(RoundTimer *timer, bool keep_running) {
+    bool is_running = timer->started;
+    round_timer_reset(timer);
+    if(!round_timers_running()) timer_cancel(&update_timer);
+    if(timer != current_timer()) {
+        if(is_running && keep_running) round_timer_start(timer);
+        return;
+    }
     if(is_running && keep_running) start_stopwatch();
     update_stopwatch();
 
@@ -270,51 +345,110 @@ void reset_stopwatch(bool keep_running) {
     strcpy(new_period_text, "");
     strcpy(round_count_text, round_count_digits);
     strcpy(elapsed_count_text, "00:00.0");
+    strcpy(paused_count_text, "00:00.0");
 
     // Animate all the laps away.
-    busy_animating = LAP_TIME_SIZE;
     static PropertyAnimation animations[LAP_TIME_SIZE];
     static GRect targets[LAP_TIME_SIZE];
     for(int i = 0; i < LAP_TIME_SIZE; ++i) {
         shift_lap_layer(&animations[i], &lap_layers[i].layer, &targets[i], LAP_TIME_SIZE);
-        animation_schedule(&animations[i].animation);
     }
     next_lap_layer = 0;
     clear_stored_laps();
 }
 
+void reset_stopwatch(bool keep_running) {
+    // The settings changed under every timer, so they all start over.
+    // A program keeps its own round count whatever the config screen says.
+    if(program_loaded()) total_round_count = program_rounds();
+    for(int i = 0; i < ROUND_TIMER_COUNT; ++i) {
+        if(i != shown_timer) reset_round_timer(&round_timers[i], keep_running);
+    }
+    reset_round_timer(current_timer(), keep_running);
+}
+
+void reset_all_work() {
+    // Resetting everything covers the shown timer too.
+    deferred_cancel(DEFER_RESET_TIMER);
+    timers_to_reset = 0;
+    reset_stopwatch(false);
+}
+
+void reset_timer_work() {
+    uint8_t which = timers_to_reset;
+    timers_to_reset = 0;
+    if(busy_animating) return;
+
+    for(int i = 0; i < ROUND_TIMER_COUNT; ++i) {
+        if(which & (1 << i)) reset_round_timer(&round_timers[i], true);
+    }
+}
+
 void reset_stopwatch_handler(ClickRecognizerRef recognizer, Window *window) {
     if(busy_animating) return;
 
-    reset_stopwatch(true);
+    timers_to_reset |= 1 << shown_timer;
+    deferred_post(DEFER_RESET_TIMER);
+}
+
+void next_timer_handler(ClickRecognizerRef recognizer, Window *window) {
+    // The period swoop doesn't hold up the other buttons, but switching
+    // timers would start it over halfway through.
+    if(busy_animating || animations_running) return;
+
+    shown_timer = (shown_timer + 1) % ROUND_TIMER_COUNT;
+    deferred_post(DEFER_SHOW_TIMER);
+}
+
+void show_timer_work() {
+    // This redraws everything.
+    deferred_cancel(DEFER_REDRAW);
+
+    itoa1(shown_timer + 1, &timer_number_text[1]);
+    text_layer_set_text(&timer_number_layer, timer_number_text);
+
+    RoundTimer *timer = current_timer();
+    strcpy(round_count_text, round_count_digits);
+    if(timer->last_period == -1) {
+        strcpy(period_text, "");
+        text_layer_set_text(&period_layer, period_text);
+    } else {
+        display_new_period();
+    }
+    update_stopwatch();
 }
 
 void lap_time_handler(ClickRecognizerRef recognizer, Window *window) {
     if(busy_animating) return;
-    time_t elapsed = elapsed_time;
-    int t = elapsed - last_lap_time;
-    last_lap_time = elapsed;
+    RoundTimer *timer = current_timer();
+    time_t elapsed = round_timer_elapsed(timer);
+    int t = elapsed - timer->last_lap_time;
+    timer->last_lap_time = elapsed;
+    session_lap(&timer->session, t);
     save_lap_time(t);
 }
 
 void update_stopwatch() {
+    STAT_TIME_BEGIN(STAT_TIME_UPDATE);
     static char big_time[] = "00:00";
     static char deciseconds_time[] = ".0";
     static char seconds_time[] = ":00";
 
     // Now convert to hours/minutes/seconds.
-    time_t effective_time = current_counter();
+    time_t elapsed_time = round_timer_elapsed(current_timer());
+    time_t effective_time = current_counter(elapsed_time);
 
     int tenths = (effective_time / 100) % 10;
     int seconds = (effective_time / 1000) % 60;
     int minutes = (effective_time / 60000) % 60;
     int hours = effective_time / 3600000;
 
-    int current_round_number = current_round_count();
+    int current_round_number = current_round_count(elapsed_time);
 
     // We can't fit three digit hours, so stop timing here.
     if(hours > 99) {
         stop_stopwatch();
+        STAT_TIME_END(STAT_TIME_UPDATE);
         return;
     }
     if(hours < 1)
@@ -341,19 +475,54 @@ void update_stopwatch() {
     itoa1(elapsed_tenths, &elapsed_count_text[6]);
 
     // Now draw the strings.
-    text_layer_set_text(&big_time_layer, big_time);
-    text_layer_set_text(&seconds_time_layer, hours < 1 ? deciseconds_time : seconds_time);
+    bool deferred = paced_set_text(&big_time_layer, big_time);
+    deferred |= paced_set_text(&seconds_time_layer, hours < 1 ? deciseconds_time : seconds_time);
 
-    text_layer_set_text(&elapsed_text_layer, elapsed_count_text);
+    deferred |= paced_set_text(&elapsed_text_layer, elapsed_count_text);
+
+    time_t paused_time = round_timer_paused(current_timer());
+    itoa2((paused_time / 60000) % 60, &paused_count_text[0]);
+    itoa2((paused_time / 1000) % 60, &paused_count_text[3]);
+    itoa1((paused_time / 100) % 10, &paused_count_text[6]);
+    deferred |= paced_set_text(&paused_text_layer, paused_count_text);
 
     if (total_round_count != 0) {
         itoa2(total_round_count - current_round_number, round_count_text);
-        text_layer_set_text(&count_layer, round_count_text);
+        deferred |= paced_set_text(&count_layer, round_count_text);
+    }
+    if (deferred) STAT_INC(STAT_SAVED_FRAMES);
+    STAT_TIME_END(STAT_TIME_UPDATE);
+}
+
+// Returns true if the redraw was left to a running animation.
+bool paced_set_text(TextLayer *layer, const char *text) {
+    // Swapping buffers (hours appearing) still needs the real call.
+    if (!animations_running || text_layer_get_text(layer) != text) {
+        text_layer_set_text(layer, text);
+        return false;
+    }
+    for (unsigned int i = 0; i < PACED_LAYER_COUNT; ++i) {
+        if (paced_layers[i] == layer) paced_dirty[i] = true;
+    }
+    return true;
+}
+
+void animation_began() {
+    ++animations_running;
+}
+
+void animation_ended() {
+    if (--animations_running) return;
+    for (unsigned int i = 0; i < PACED_LAYER_COUNT; ++i) {
+        if (!paced_dirty[i]) continue;
+        paced_dirty[i] = false;
+        layer_mark_dirty(&paced_layers[i]->layer);
     }
 }
 
 void animation_stopped(Animation *animation, void *data) {
     --busy_animating;
+    animation_ended();
 }
 
 static PropertyAnimation period_animation;
@@ -368,13 +537,31 @@ void do_period_swoop_part2(Animation *animation, void *data) {
     animation_set_curve(&period_animation2.animation, AnimationCurveEaseOut);
     animation_set_delay(&period_animation2.animation, 50);
     animation_set_handlers(&period_animation2.animation, (AnimationHandlers){
-        .started = (AnimationStartedHandler)set_period_text
+        .started = (AnimationStartedHandler)set_period_text,
+        .stopped = (AnimationStoppedHandler)animation_ended
     }, NULL);
+    animation_began();
     animation_schedule(&period_animation2.animation);
-
+    // Only now let go of the first half, so nothing flushes in between.
+    if (animation) animation_ended();
 }
 
 void do_period_swoop() {
+    // If one is still going, stop it before its animations are reused.
+    // Stopping runs their stopped handlers, so the count stays even:
+    // the first half hands over to the second, which is stopped in turn.
+    if (animation_is_scheduled(&period_animation.animation)) animation_unschedule(&period_animation.animation);
+    if (animation_is_scheduled(&period_animation2.animation)) animation_unschedule(&period_animation2.animation);
+    // Ask about the trip the swoop makes, not where the layer sits now: it's
+    // parked off screen until the first swoop. The second half always runs
+    // and ends in place, so if that's hidden, so is the first.
+    if (!layer_on_screen(&period_layer.layer, &GRect(-139, 10, 139, 50), &GRect(0, 10, 139, 50))) {
+        // Nobody's looking, so just put the new text in place.
+        set_period_text(NULL, NULL);
+        layer_set_frame(&period_layer.layer, GRect(0, 10, 139, 50));
+        STAT_INC(STAT_SKIPPED_ANIMATIONS);
+        return;
+    }
     if (strcmp(period_text, "") != 0) {
         property_animation_init_layer_frame(&period_animation, &period_layer.layer, &GRect(0, 10, 139, 50), &GRect(139, 10, 139, 50));
         animation_set_curve(&period_animation.animation, AnimationCurveEaseOut);
@@ -382,6 +569,7 @@ void do_period_swoop() {
         animation_set_handlers(&period_animation.animation, (AnimationHandlers){
             .stopped = (AnimationStoppedHandler)do_period_swoop_part2
         }, NULL);
+        animation_began();
         animation_schedule(&period_animation.animation);
     }
     else {
@@ -391,7 +579,7 @@ void do_period_swoop() {
 }
 
 void display_new_period() {
-    int current_period = get_round_period();
+    int current_period = get_round_period(round_timer_elapsed(current_timer()));
 
     if (current_period == 1) {
         strcpy(new_period_text, "Warning");
@@ -402,20 +590,63 @@ void display_new_period() {
     else if (current_period == 0) {
         strcpy(new_period_text, "Round");
     }
+    else if (current_period == PROGRAM_WARMUP) {
+        strcpy(new_period_text, "Warmup");
+    }
+    else if (current_period == PROGRAM_COOLDOWN) {
+        strcpy(new_period_text, "Cooldown");
+    }
 
     do_period_swoop();
 }
 
-void shift_lap_layer(PropertyAnimation* animation, Layer* layer, GRect* target, int distance_multiplier) {
-    GRect origin = layer_get_frame(layer);
-    *target = origin;
-    target->origin.y += target->size.h * distance_multiplier;
-    property_animation_init_layer_frame(animation, layer, NULL, target);
+// Whether animating a layer from one frame to another would show at all.
+// It has to be in the window on top, not hidden (nor anything above it),
+// and on screen for some of the way. NULL frames mean where it is now.
+bool layer_on_screen(Layer *layer, GRect *from, GRect *to) {
+    Window *window = layer_get_window(layer);
+    if(!window || window != window_stack_get_top_window()) return false;
+    for(Layer *l = layer; l; l = l->parent) {
+        if(layer_get_hidden(l)) return false;
+    }
+    if(!layer->parent) return true;
+    GRect bounds = layer->parent->bounds;
+    GRect frame = from ? *from : layer_get_frame(layer);
+    GRect end = to ? *to : frame;
+    // Frames only move in straight lines, so the box around both ends covers the whole trip.
+    int16_t left = frame.origin.x < end.origin.x ? frame.origin.x : end.origin.x;
+    int16_t top = frame.origin.y < end.origin.y ? frame.origin.y : end.origin.y;
+    int16_t right = frame.origin.x + frame.size.w > end.origin.x + end.size.w ? frame.origin.x + frame.size.w : end.origin.x + end.size.w;
+    int16_t bottom = frame.origin.y + frame.size.h > end.origin.y + end.size.h ? frame.origin.y + frame.size.h : end.origin.y + end.size.h;
+    return right > bounds.origin.x && left < bounds.origin.x + bounds.size.w &&
+           bottom > bounds.origin.y && top < bounds.origin.y + bounds.size.h;
+}
+
+// Layers we can't see go straight to their target, which costs nothing
+// and doesn't hold up the buttons.
+void animate_lap_layer(PropertyAnimation* animation, Layer* layer, GRect* origin, GRect* target, int delay, AnimationCurve curve) {
+    if(!layer_on_screen(layer, origin, target)) {
+        layer_set_frame(layer, *target);
+        STAT_INC(STAT_SKIPPED_ANIMATIONS);
+        return;
+    }
+    property_animation_init_layer_frame(animation, layer, origin, target);
     animation_set_duration(&animation->animation, 250);
-    animation_set_curve(&animation->animation, AnimationCurveLinear);
+    animation_set_delay(&animation->animation, delay);
+    animation_set_curve(&animation->animation, curve);
     animation_set_handlers(&animation->animation, (AnimationHandlers){
         .stopped = (AnimationStoppedHandler)animation_stopped
     }, NULL);
+    ++busy_animating;
+    animation_began();
+    animation_schedule(&animation->animation);
+}
+
+void shift_lap_layer(PropertyAnimation* animation, Layer* layer, GRect* target, int distance_multiplier) {
+    GRect origin = layer_get_frame(layer);
+    *target = origin;
+    target->origin.y += target->size.h * distance_multiplier;
+    animate_lap_layer(animation, layer, NULL, target, 0, AnimationCurveLinear);
 }
 
 void save_lap_time(int lap_time) {
@@ -425,11 +656,9 @@ void save_lap_time(int lap_time) {
     static GRect targets[LAP_TIME_SIZE];
 
     // Shift them down visually (assuming they actually exist)
-    busy_animating = LAP_TIME_SIZE;
     for(int i = 0; i < LAP_TIME_SIZE; ++i) {
         if(i == next_lap_layer) continue; // This is handled separately.
         shift_lap_layer(&animations[i], &lap_layers[i].layer, &targets[i], 1);
-        animation_schedule(&animations[i].animation);
     }
 
     // Once those are done we can slide our new lap time in.
@@ -439,110 +668,70 @@ void save_lap_time(int lap_time) {
     static PropertyAnimation entry_animation;
     //static GRect origin; origin = ;
     //static GRect target; target = ;
-    property_animation_init_layer_frame(&entry_animation, &lap_layers[next_lap_layer].layer, &GRect(-139, 52, 139, 26), &GRect(5, 52, 139, 26));
-    animation_set_curve(&entry_animation.animation, AnimationCurveEaseOut);
-    animation_set_delay(&entry_animation.animation, 50);
-    animation_set_handlers(&entry_animation.animation, (AnimationHandlers){
-        .stopped = (AnimationStoppedHandler)animation_stopped
-    }, NULL);
-    animation_schedule(&entry_animation.animation);
+    animate_lap_layer(&entry_animation, &lap_layers[next_lap_layer].layer, &GRect(-139, 52, 139, 26), &GRect(5, 52, 139, 26), 50, AnimationCurveEaseOut);
     next_lap_layer = (next_lap_layer + 1) % LAP_TIME_SIZE;
 
     // Get it into the laps window, too.
     store_lap_time(lap_time);
 }
 
-time_t single_round_running_time() {
-    time_t running_time = elapsed_time;
-    time_t full_round = round_time + rest_time;
-    for (; running_time > full_round; running_time -= full_round);
+void period_changed(RoundTimer *timer) {
+    time_t elapsed = round_timer_elapsed(timer);
+    int current_period = get_round_period(elapsed);
+    // Back to back work segments are the same period, but each still
+    // wants its cue.
+    int current_segment = program_loaded() ? program_segment(elapsed) : -1;
 
-    return running_time;
-}
-
-int get_round_period() {
-    // If we are within a round period: 0
-    // If we are within a warning period: 1
-    // If we are within a resting period: 2
-
-    time_t running_time = single_round_running_time();
-
-    if (running_time < round_time) {
-        if (warning_time != 0 && running_time > round_time - warning_time) {
-            return 1;
-        }
-        return 0;
-    }
-    return 2;
-}
-
-time_t current_counter() {
-    time_t running_time = single_round_running_time();
-
-    if (running_time < round_time) {
-        return round_time - running_time;
-    }
-    running_time -= round_time;
-    return rest_time - running_time;
-}
+    if (current_period != timer->last_period || current_segment != timer->last_segment) {
+        int current_round_number = current_round_count(elapsed);
 
-int current_round_count() {
-    time_t running_time = elapsed_time;
-    time_t full_round = round_time + rest_time;
-    int round_counter = 0;
-    for (; running_time > full_round; running_time -= full_round) round_counter++;
-
-    return round_counter;
-}
-
-void period_changed() {
-    int current_period = get_round_period();
-
-    if (current_period != last_period) {
-        int current_round_number = current_round_count();
-
-        if (total_round_count != 0 && current_round_number == total_round_count) {
+        // A program is over when it runs out, whatever its round count.
+        if ((total_round_count != 0 && current_round_number == total_round_count) || current_period == PROGRAM_DONE) {
             // We're very done
             vibes_enqueue_custom_pattern(all_rounds_done_pattern);
-            reset_stopwatch(false);
+            reset_round_timer(timer, false);
             return;
         }
         if (current_period == 1) {
             vibes_double_pulse();
         }
-        else if (current_period == 2) {
+        else if (current_period == 2 || current_period == PROGRAM_COOLDOWN) {
             vibes_enqueue_custom_pattern(round_done_pattern);
         }
         else if (current_period == 0) {
             vibes_long_pulse();
         }
-        display_new_period();
+        if (timer == current_timer()) display_new_period();
     }
-    last_period = current_period;
+    timer->last_period = current_period;
+    timer->last_segment = current_segment;
+}
+
+void handle_tick(void *data) {
+    // Period changes are taken care of by each timer's own boundary timer,
+    // so all that's left here is the clock and whichever timer is on screen.
+    // A paused one still has its pause counter going.
+    STAT_INC(STAT_TICKS);
+    STAT_TIME_BEGIN(STAT_TIME_TICK);
+    TRACE_TICK(tick_due, clock_now());
+    round_timers_sync();
+    RoundTimer *timer = current_timer();
+    time_t elapsed = round_timer_elapsed(timer);
+    time_t period = !timer->started || elapsed <= 3600000 ? 100 : 1000;
+    schedule_tick(clock_phase_delay(period));
+    if(elapsed) update_stopwatch();
+    STAT_TIME_END(STAT_TIME_TICK);
 }
 
 void handle_timer(AppContextRef ctx, AppTimerHandle handle, uint32_t cookie) {
-    (void)handle;
-    if(cookie == TIMER_UPDATE) {
-        if(started) {
-            elapsed_time += 100;
-            // Every tick of the pebble clock, force our time back to it.
-            time_t pebble_time = get_pebble_time();
-            if(!last_pebble_time) last_pebble_time = pebble_time;
-            if(pebble_time > last_pebble_time) {
-                // If it's the first tick, instead of changing our time we calculate the correct time.
-                if(!start_time) {
-                    start_time = pebble_time - elapsed_time;
-                } else {
-                    elapsed_time = pebble_time - start_time;
-                }
-                last_pebble_time = pebble_time;
-            }
-            update_timer = app_timer_send_event(ctx, elapsed_time <= 3600000 ? 100 : 1000, TIMER_UPDATE);
-            period_changed();
-        }
-        update_stopwatch();
-    }
+    // Everything timed goes through the wheel. The bench and replay pump
+    // themselves with events of their own, which aren't real wakeups.
+    STAT_TIME_BEGIN(STAT_TIME_WHEEL);
+    if(timers_handle_event(ctx, handle, cookie)) STAT_INC(STAT_WAKEUPS);
+    STAT_TIME_END(STAT_TIME_WHEEL);
+    BENCH_HANDLE_EVENT(ctx, handle, cookie);
+    REPLAY_HANDLE_EVENT(ctx, handle, cookie);
+    STATS_FRAME_END();
 }
 
 void handle_display_lap_times(ClickRecognizerRef recognizer, Window *window) {
@@ -552,9 +741,11 @@ void handle_display_lap_times(ClickRecognizerRef recognizer, Window *window) {
 void main_config_provider(ClickConfig **config, Window *window) {
     config[BUTTON_RUN]->click.handler = (ClickHandler)toggle_stopwatch_handler;
     config[BUTTON_RESET]->click.handler = (ClickHandler)reset_stopwatch_handler;
+    config[BUTTON_NEXT_TIMER]->click.handler = (ClickHandler)next_timer_handler;
     /*config[BUTTON_LAP]->click.handler = (ClickHandler)lap_time_handler;
     config[BUTTON_LAP]->long_click.handler = (ClickHandler)handle_display_lap_times;
     config[BUTTON_LAP]->long_click.delay_ms = 700;*/
+    REPLAY_CLICKS(REPLAY_MAIN_WINDOW, config);
     (void)window;
 }
 
@@ -562,7 +753,13 @@ void pbl_main(void *params) {
   PebbleAppHandlers handlers = {
     .init_handler = &handle_init,
     .deinit_handler = &handle_deinit,
-    .timer_handler = &handle_timer
+    .timer_handler = &handle_timer,
+    .messaging_info = {
+      .buffer_sizes = {
+        .inbound = 16,
+        .outbound = EXPORT_OUTBOUND_SIZE
+      }
+    }
   };
   app_event_loop(params, &handlers);
 }
@@ -0,0 +1,291 @@
+/*
+ * Pebble Round Timer - timer wheel
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "timers.h"
+
+// All of the app's timed work hangs off one app timer. The timers
+// themselves live in a hierarchical wheel with millisecond resolution:
+// level 0 holds the next 32ms one slot per ms, level 1 the next ~1s in
+// 32ms slots and so on, which covers ~17 minutes. Anything further out
+// parks in the last level and gets re-filed as the wheel turns.
+// Scheduling and cancelling are just list splices, and finding the next
+// deadline looks at one slot per level.
+
+// The documentation claims this is defined, but it is not.
+// Define it here for now.
+#ifndef APP_TIMER_INVALID_HANDLE
+    #define APP_TIMER_INVALID_HANDLE 0xDEADBEEF
+#endif
+
+#define TIMER_WHEEL 0x7157
+#define WHEEL_BITS 5
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4
+#define WHEEL_SPAN ((uint32_t)1 << (WHEEL_BITS * WHEEL_LEVELS))
+
+static AppContextRef timers_app;
+static Timer *wheel[WHEEL_LEVELS][WHEEL_SIZE];
+static uint32_t occupied[WHEEL_LEVELS];
+// Earliest expiry filed into each slot above level 0 since it was last
+// empty. A cancel can leave it too early; that costs one wakeup, after
+// which it has passed and the slot is looked through again.
+static uint32_t slot_soonest[WHEEL_LEVELS - 1][WHEEL_SIZE];
+static int pending_count = 0;
+static uint32_t wheel_now = 0;
+// Time the clock says has passed that the wheel hasn't turned through
+// yet. timers_now() counts it straight away; the wheel pays it back.
+static uint32_t owed = 0;
+
+// The one real timer. We never rely on cancelling it: an event that
+// doesn't carry the handle we're waiting on is simply ignored.
+static AppTimerHandle wheel_handle = APP_TIMER_INVALID_HANDLE;
+static uint32_t armed_at = 0;
+static uint32_t armed_delay = 0;
+static bool dispatching = false;
+
+static void timer_file(Timer *timer) {
+    uint32_t delta = timer->expires - wheel_now;
+    if((int32_t)delta < 0) delta = 0;
+    if(delta >= WHEEL_SPAN) delta = WHEEL_SPAN - 1;
+
+    int level = 0;
+    while(level < WHEEL_LEVELS - 1 && delta >> (WHEEL_BITS * (level + 1))) ++level;
+    int slot = ((wheel_now + delta) >> (WHEEL_BITS * level)) & WHEEL_MASK;
+
+    if(level) {
+        uint32_t *soonest = &slot_soonest[level - 1][slot];
+        if(!(occupied[level] & (1u << slot)) || (int32_t)(timer->expires - *soonest) < 0) *soonest = timer->expires;
+    }
+
+    Timer **head = &wheel[level][slot];
+    timer->next = *head;
+    if(*head) (*head)->pprev = &timer->next;
+    *head = timer;
+    timer->pprev = head;
+    timer->level = level;
+    timer->slot = slot;
+    occupied[level] |= 1u << slot;
+}
+
+static void timer_unfile(Timer *timer) {
+    *timer->pprev = timer->next;
+    if(timer->next) timer->next->pprev = timer->pprev;
+    timer->next = NULL;
+    timer->pprev = NULL;
+    if(!wheel[timer->level][timer->slot]) {
+        occupied[timer->level] &= ~(1u << timer->slot);
+    }
+}
+
+static void cascade(int level) {
+    int slot = (wheel_now >> (WHEEL_BITS * level)) & WHEEL_MASK;
+    Timer *timer = wheel[level][slot];
+    wheel[level][slot] = NULL;
+    occupied[level] &= ~(1u << slot);
+    while(timer) {
+        Timer *next = timer->next;
+        timer_file(timer);
+        timer = next;
+    }
+}
+
+static void run_slot(int slot) {
+    while(wheel[0][slot]) {
+        Timer *timer = wheel[0][slot];
+        timer_unfile(timer);
+        --pending_count;
+        timer->callback(timer->data);
+    }
+}
+
+// The first occupied slot after the current one, counting around the
+// wheel. Returns how many slots away it is, or 0 if the level is empty.
+static uint32_t next_occupied(int level) {
+    if(!occupied[level]) return 0;
+    int index = (wheel_now >> (WHEEL_BITS * level)) & WHEEL_MASK;
+    uint32_t rotated = (occupied[level] >> index) | (occupied[level] << ((WHEEL_SIZE - index) & WHEEL_MASK));
+    rotated &= ~1u; // The current slot is only ever a full turn away.
+    if(!rotated) return WHEEL_SIZE;
+    return __builtin_ctz(rotated);
+}
+
+static void timers_advance(uint32_t ms) {
+    while(ms) {
+        // Skip straight to whichever comes first: something to run, the
+        // end of this turn of level 0, or the end of the time we have.
+        uint32_t index = wheel_now & WHEEL_MASK;
+        uint32_t step = WHEEL_SIZE - index;
+        uint32_t next = next_occupied(0);
+        if(next && next < step) step = next;
+        if(step > ms) step = ms;
+
+        wheel_now += step;
+        ms -= step;
+        owed -= step < owed ? step : owed;
+
+        if(!(wheel_now & WHEEL_MASK)) {
+            int top = 1;
+            while(top < WHEEL_LEVELS - 1 && !((wheel_now >> (WHEEL_BITS * top)) & WHEEL_MASK)) ++top;
+            for(int level = top; level > 0; --level) cascade(level);
+        }
+        run_slot(wheel_now & WHEEL_MASK);
+    }
+}
+
+// How long until something in the wheel is due. Only the nearest occupied
+// slot on each level has to be looked at, since slots are in time order,
+// and each of those knows its soonest expiry, so no lists are walked.
+static uint32_t next_deadline() {
+    uint32_t best = WHEEL_SPAN;
+    uint32_t next = next_occupied(0);
+    if(next) best = next;
+    for(int level = 1; level < WHEEL_LEVELS; ++level) {
+        next = next_occupied(level);
+        if(!next) continue;
+        int slot = ((wheel_now >> (WHEEL_BITS * level)) + next) & WHEEL_MASK;
+        uint32_t *soonest = &slot_soonest[level - 1][slot];
+        if((int32_t)(*soonest - wheel_now) <= 0) {
+            Timer *timer = wheel[level][slot];
+            *soonest = timer->expires;
+            for(; timer; timer = timer->next) {
+                if((int32_t)(timer->expires - *soonest) < 0) *soonest = timer->expires;
+            }
+        }
+        uint32_t delta = *soonest - wheel_now;
+        if(delta < best) best = delta;
+    }
+    return best;
+}
+
+static void timers_rearm() {
+    if(dispatching || !pending_count) return;
+    uint32_t delay = next_deadline();
+    if(wheel_handle != APP_TIMER_INVALID_HANDLE) {
+        // Already waiting on something at least as soon? Leave it be.
+        if(armed_at + armed_delay <= wheel_now + delay) return;
+        // Otherwise drop it. Whatever time it had been waiting for is lost
+        // to the wheel until the clock next resyncs and credits it back.
+        app_timer_cancel_event(timers_app, wheel_handle);
+    }
+    armed_at = wheel_now;
+    armed_delay = delay;
+    wheel_handle = app_timer_send_event(timers_app, delay, TIMER_WHEEL);
+}
+
+void timers_init(AppContextRef ctx) {
+    timers_app = ctx;
+}
+
+void timer_init(Timer *timer, TimerCallback callback, void *data) {
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->callback = callback;
+    timer->data = data;
+}
+
+void timer_schedule(Timer *timer, uint32_t delay) {
+    if(timer->pprev) {
+        timer_unfile(timer);
+    } else {
+        ++pending_count;
+    }
+    // Anything due now would land in the slot we've already run.
+    timer->expires = timers_now() + (delay ? delay : 1);
+    timer_file(timer);
+    timers_rearm();
+}
+
+void timer_cancel(Timer *timer) {
+    if(!timer->pprev) return;
+    timer_unfile(timer);
+    --pending_count;
+}
+
+bool timer_is_pending(Timer *timer) {
+    return timer->pprev != NULL;
+}
+
+uint32_t timers_now() {
+    return wheel_now + owed;
+}
+
+// How much longer the app timer we're waiting on has to go, or 0 if
+// there's none. Anything that happens between wakeups happens before then.
+uint32_t timers_wait_left() {
+    if(wheel_handle == APP_TIMER_INVALID_HANDLE || dispatching) return 0;
+    uint32_t left = armed_at + armed_delay - timers_now();
+    return (int32_t)left > 0 ? left : 0;
+}
+
+// Turns the wheel through whatever is owed, running what falls due.
+static void catch_up() {
+    while(owed) timers_advance(owed);
+}
+
+// The clock found more time had passed than the wheel knows about: the
+// app timer was late, or was cancelled part way through its wait.
+void timers_credit(uint32_t ms) {
+    owed += ms;
+    if(dispatching) return; // paid back once the current turn is done
+    dispatching = true;
+    catch_up();
+    dispatching = false;
+    timers_rearm();
+}
+
+// For running at simulated time: how long until something is due, and a
+// way to get there without waiting. Whatever the app timer was waiting
+// on is dropped; it gets armed again for whatever is left afterwards.
+uint32_t timers_until_next() {
+    return pending_count ? next_deadline() : WHEEL_SPAN;
+}
+
+void timers_fast_forward(uint32_t ms) {
+    if(wheel_handle != APP_TIMER_INVALID_HANDLE) {
+        app_timer_cancel_event(timers_app, wheel_handle);
+        wheel_handle = APP_TIMER_INVALID_HANDLE;
+    }
+    dispatching = true;
+    timers_advance(ms);
+    catch_up();
+    dispatching = false;
+    timers_rearm();
+}
+
+bool timers_handle_event(AppContextRef ctx, AppTimerHandle handle, uint32_t cookie) {
+    if(cookie != TIMER_WHEEL || handle != wheel_handle) return false;
+    wheel_handle = APP_TIMER_INVALID_HANDLE;
+
+    // A credit since we armed may already have taken us part of the way.
+    uint32_t target = armed_at + armed_delay;
+    dispatching = true;
+    if((int32_t)(target - wheel_now) > 0) timers_advance(target - wheel_now);
+    catch_up();
+    dispatching = false;
+
+    timers_rearm();
+    return true;
+}
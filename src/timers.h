@@ -0,0 +1,48 @@
+/*
+ * Pebble Round Timer - timer wheel header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+typedef void (*TimerCallback)(void *data);
+
+// Storage belongs to the caller, like a PropertyAnimation. Keep it static.
+typedef struct Timer {
+    struct Timer *next;
+    struct Timer **pprev; // NULL while the timer isn't pending
+    uint32_t expires;
+    uint8_t level;
+    uint8_t slot;
+    TimerCallback callback;
+    void *data;
+} Timer;
+
+void timers_init(AppContextRef ctx);
+void timer_init(Timer *timer, TimerCallback callback, void *data);
+void timer_schedule(Timer *timer, uint32_t delay);
+void timer_cancel(Timer *timer);
+bool timer_is_pending(Timer *timer);
+uint32_t timers_now();
+uint32_t timers_wait_left();
+void timers_credit(uint32_t ms);
+uint32_t timers_until_next();
+void timers_fast_forward(uint32_t ms);
+// Returns whether the event was the wheel's own.
+bool timers_handle_event(AppContextRef ctx, AppTimerHandle handle, uint32_t cookie);
@@ -0,0 +1,75 @@
+/*
+ * Pebble Round Timer - tick trace
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "trace.h"
+
+#ifdef ROUNDTIMER_TRACE
+
+#define TRACE_TICK_ENTRY 'T'
+#define TRACE_EDGE_ENTRY 'E'
+
+// A tick: when it came and how late that was against when it was due.
+// An edge: the clock reading it was found at and the correction applied.
+// Everything is clock time, so a long pause shows up as a long gap and
+// nothing wraps for a few weeks.
+typedef struct {
+    int32_t at;
+    int16_t value;
+    char kind;
+} TraceEntry;
+
+static TraceEntry entries[TRACE_SIZE];
+static int trace_head = 0;
+static int trace_length = 0;
+
+static void trace_add(char kind, time_t at, time_t value) {
+    TraceEntry *entry = &entries[trace_head];
+    entry->kind = kind;
+    entry->at = at;
+    // Anything past half a minute either way is broken anyway.
+    entry->value = value > 32767 ? 32767 : value < -32768 ? -32768 : value;
+    trace_head = (trace_head + 1) % TRACE_SIZE;
+    if(trace_length < TRACE_SIZE) ++trace_length;
+}
+
+void trace_tick(time_t due, time_t came) {
+    trace_add(TRACE_TICK_ENTRY, came, came - due);
+}
+
+void trace_edge(time_t at, time_t correction) {
+    trace_add(TRACE_EDGE_ENTRY, at, correction);
+}
+
+// Oldest first, one line per entry.
+void trace_log() {
+    int index = (trace_head - trace_length + TRACE_SIZE) % TRACE_SIZE;
+    for(int i = 0; i < trace_length; ++i) {
+        TraceEntry *entry = &entries[index];
+        APP_LOG(APP_LOG_LEVEL_INFO, "TRACE %c %ld %d", entry->kind, (long)entry->at, (int)entry->value);
+        index = (index + 1) % TRACE_SIZE;
+    }
+}
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ * Pebble Round Timer - tick trace header
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+// Uncomment to keep a trace of the last TRACE_SIZE ticks and pebble second
+// edges (a bit under a minute of 100 ms ticks) in RAM. Both are read off
+// the shared clock: a tick says when it was due and when it came, an edge
+// how far the clock moved to agree with the pebble clock. It's written to
+// the app log when the app exits; tools/trace_report.py turns that into
+// lateness, jitter and drift histograms.
+//#define ROUNDTIMER_TRACE
+
+#define TRACE_SIZE 512
+
+#ifdef ROUNDTIMER_TRACE
+
+void trace_tick(time_t due, time_t came);
+void trace_edge(time_t at, time_t correction);
+void trace_log();
+
+#define TRACE_TICK(due, came) trace_tick(due, came)
+#define TRACE_EDGE(at, correction) trace_edge(at, correction)
+#define TRACE_LOG() trace_log()
+
+#else
+
+#define TRACE_TICK(due, came)
+#define TRACE_EDGE(at, correction)
+#define TRACE_LOG()
+
+#endif
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Summarise a ROUNDTIMER_BENCH run and compare it with a baseline.
+
+Feed it the app log of a bench build (see src/bench.h), or let
+tools/bench_host.py build and run one on the host. Every scenario logs a
+{"bench": ...} line followed by the usual stats summary. Host runs add
+{"host": ...} lines: each scenario's CPU time, and for the "run" as a
+whole the peak stack and the static RAM (data + bss) of src/.
+
+  bench_compare.py run.log                         table only
+  bench_compare.py run.log --write-baseline        record tools/bench_baseline.json
+  bench_compare.py run.log --tolerance 2           exit 1 if anything got >2% worse
+  bench_compare.py run.log --cpu-tolerance 20      ... or if host CPU time got >20% worse
+
+Counts are exact for a given build, so any change in them shows up. So
+are the stack and RAM sizes, for a given compiler. Cycle counts come from
+ROUNDTIMER_STATS_CYCLES builds on the watch only. Host CPU time changes
+from one run and one machine to the next, so it's only checked when
+asked, and then against a baseline recorded on the same machine.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "bench_baseline.json")
+
+# Lower is better for everything we compare except HIGHER_IS_BETTER.
+METRICS = ["wakeups", "ticks", "frames", "set_text", "invalidations", "pixels", "glyphs", "saved_frames", "cycles",
+           "cycles_per_tick", "ticks_per_cpu_second", "peak_stack", "static_ram"]
+# Host CPU time, checked with --cpu-tolerance only.
+TIMINGS = ["host_cpu_ms", "host_tick_rate"]
+HIGHER_IS_BETTER = {"saved_frames", "ticks_per_cpu_second", "host_tick_rate"}
+
+
+def parse(lines, cpu_hz):
+    scenarios, current = {}, None
+    for line in lines:
+        match = re.search(r"\{.*\}", line)
+        if not match:
+            continue
+        try:
+            record = json.loads(match.group(0))
+        except ValueError:
+            continue
+        if "bench" in record:
+            if record["bench"] == "done":
+                current = None
+                continue
+            current = scenarios.setdefault(record["bench"], {})
+            current["simulated_ms"] = record["simulated_ms"]
+            current["cycles"] = record["cycles"]
+        elif current is not None and "stat" in record:
+            current[record["stat"]] = record["value"]
+        elif current is not None and "time" in record:
+            current["%s_cycles" % record["time"]] = record["cycles"]
+        elif "host" in record:
+            results = scenarios.setdefault(record.pop("host"), {})
+            if "cpu_ns" in record:
+                results["host_cpu_ms"] = record.pop("cpu_ns") / 1e6
+            results.update(record)
+
+    for results in scenarios.values():
+        ticks, cycles = results.get("ticks", 0), results.get("cycles", 0)
+        if ticks and cycles:
+            results["cycles_per_tick"] = cycles / ticks
+            results["ticks_per_cpu_second"] = ticks / (cycles / cpu_hz)
+        if ticks and results.get("host_cpu_ms"):
+            results["host_tick_rate"] = ticks / (results["host_cpu_ms"] / 1000)
+    return scenarios
+
+
+def show(scenarios):
+    columns = [metric for metric in METRICS + TIMINGS if any(metric in results for results in scenarios.values())]
+    print("%-20s" % "scenario" + "".join("%14s" % column[:13] for column in columns))
+    for name, results in scenarios.items():
+        cells = []
+        for column in columns:
+            value = results.get(column)
+            cells.append("%14s" % ("-" if value is None else "%.1f" % value if isinstance(value, float) else value))
+        print("%-20s" % name + "".join(cells))
+
+
+def compare(scenarios, baseline, tolerance, cpu_tolerance):
+    worse = []
+    for name, results in scenarios.items():
+        if name not in baseline:
+            print("%s: not in the baseline" % name)
+            continue
+        for metric in METRICS + TIMINGS:
+            old, new = baseline[name].get(metric), results.get(metric)
+            if not old or new is None:
+                continue
+            allowed = tolerance if metric in METRICS else cpu_tolerance
+            if allowed is None:
+                continue
+            change = 100.0 * (new - old) / old
+            if metric in HIGHER_IS_BETTER:
+                change = -change
+            if change > allowed:
+                worse.append("%s %s: %.6g -> %.6g (%+.1f%% worse)" % (name, metric, old, new, change))
+            elif change < -allowed:
+                print("%s %s: %.6g -> %.6g (%.1f%% better)" % (name, metric, old, new, -change))
+    for line in worse:
+        print(line)
+    return not worse
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", type=argparse.FileType("r"), default=sys.stdin)
+    parser.add_argument("--baseline", default=BASELINE)
+    parser.add_argument("--write-baseline", action="store_true", help="save this run as the baseline")
+    parser.add_argument("--tolerance", type=float, default=1.0, help="percent a metric may get worse (default 1)")
+    parser.add_argument("--cpu-tolerance", type=float, help="percent host CPU time may get worse (default: not checked)")
+    parser.add_argument("--cpu-hz", type=float, default=64e6, help="CPU clock for cycles -> seconds (default 64 MHz)")
+    args = parser.parse_args()
+
+    scenarios = parse(args.log, args.cpu_hz)
+    if not scenarios:
+        sys.exit("no bench results in the log")
+    show(scenarios)
+
+    if args.write_baseline:
+        with open(args.baseline, "w") as output:
+            json.dump(scenarios, output, indent=2, sort_keys=True)
+            output.write("\n")
+        return
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as baseline:
+            if not compare(scenarios, json.load(baseline), args.tolerance, args.cpu_tolerance):
+                sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
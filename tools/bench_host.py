@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Build and run the bench on the host (tools/host/bench_host.c) and compare it.
+
+Builds every module in src/ with ROUNDTIMER_STATS and ROUNDTIMER_BENCH
+against the host SDK in tools/host/pebble_host.c, runs the bench scenarios
+through the real handlers and hands the log to tools/bench_compare.py.
+Anything after the options goes to bench_compare.py:
+
+  bench_host.py                                  table, and exit 1 if worse than tools/bench_baseline.json
+  bench_host.py -- --write-baseline              record a new baseline
+  bench_host.py -- --cpu-tolerance 20            also check host CPU time
+  bench_host.py --log bench.log                  keep the log
+
+On top of the app's own counts it reports each scenario's host CPU time
+and ticks per host CPU second, the peak stack over the run, and the
+static RAM (data + bss) of src/ in this build, from `size`.
+"""
+
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HOST = os.path.join(ROOT, "tools", "host")
+APP_SOURCES = sorted(glob.glob(os.path.join(ROOT, "src", "*.c")))
+HOST_SOURCES = [os.path.join(HOST, name) for name in ("pebble_host.c", "pebble_screen.c", "bench_host.c")]
+# -fwrapv: the seconds arithmetic in common.c wraps, as it does on the watch.
+CFLAGS = ["-O2", "-std=gnu99", "-Wall", "-fwrapv", "-DROUNDTIMER_STATS", "-DROUNDTIMER_BENCH",
+          "-I", HOST, "-I", os.path.join(ROOT, "src")]
+
+
+def static_ram(size, objects):
+    total = 0
+    for path in objects:
+        output = subprocess.check_output([size, path], universal_newlines=True).splitlines()
+        total += sum(int(field) for field in output[1].split()[1:3])
+    return total
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"))
+    parser.add_argument("--size", default="size")
+    parser.add_argument("--log", help="also save the log here")
+    parser.add_argument("args", nargs=argparse.REMAINDER, help="passed to bench_compare.py after --")
+    args = parser.parse_args()
+    extra = args.args[1:] if args.args[:1] == ["--"] else args.args
+
+    with tempfile.TemporaryDirectory() as build:
+        objects = []
+        for source in APP_SOURCES + HOST_SOURCES:
+            objects.append(os.path.join(build, os.path.basename(source) + ".o"))
+            subprocess.check_call([args.cc] + CFLAGS + ["-c", "-o", objects[-1], source])
+        binary = os.path.join(build, "bench_host")
+        subprocess.check_call([args.cc, "-o", binary] + objects)
+
+        run = subprocess.run([binary], stdout=subprocess.PIPE, universal_newlines=True)
+        log = run.stdout + json.dumps({"host": "run", "static_ram": static_ram(args.size, objects[:len(APP_SOURCES)])}) + "\n"
+        if args.log:
+            with open(args.log, "w") as output:
+                output.write(log)
+        if run.returncode:
+            sys.exit(run.returncode)
+
+        log_path = os.path.join(build, "bench.log")
+        with open(log_path, "w") as output:
+            output.write(log)
+        sys.exit(subprocess.call([sys.executable, os.path.join(ROOT, "tools", "bench_compare.py"), log_path] + extra))
+
+
+if __name__ == "__main__":
+    main()
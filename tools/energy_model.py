@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Estimate what a session costs in battery from the stats counters.
+
+Reads app logs from ROUNDTIMER_STATS builds (the JSON lines written on
+exit, or per scenario by a ROUNDTIMER_BENCH build) and prices each
+counter with the per-operation costs in a JSON file (tools/energy_costs.json
+by default). Give several logs to compare policies side by side:
+
+  energy_model.py tick100.log tick1000.log --duration 3600 --backlight 20
+
+Bench scenarios know their own (simulated) length; anything else needs
+--duration. The app never turns the backlight on itself, so how long it
+was lit has to be given with --backlight.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+COSTS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "energy_costs.json")
+UAH_PER_MA_SECOND = 1000.0 / 3600.0
+
+
+def parse(path):
+    """{run name: counters} for one log."""
+    runs, current = {}, None
+    base = os.path.basename(path)
+    with open(path) as log:
+        for line in log:
+            match = re.search(r"\{.*\}", line)
+            if not match:
+                continue
+            try:
+                record = json.loads(match.group(0))
+            except ValueError:
+                continue
+            if "bench" in record:
+                current = None if record["bench"] == "done" else runs.setdefault("%s:%s" % (base, record["bench"]), {})
+                if current is not None:
+                    current["duration_ms"] = record["simulated_ms"]
+                    if record.get("cycles"):
+                        current["cycles"] = record["cycles"]
+                continue
+            if current is None:
+                current = runs.setdefault(base, {})
+            if "stat" in record:
+                current[record["stat"]] = record["value"]
+            elif "time" in record:
+                current["%s_cycles" % record["time"]] = record["cycles"]
+    # The tick and update timers run inside the wheel's, so adding them up
+    # would count that time twice or three times. A bench scenario's own
+    # total is best; otherwise the wheel covers everything timed.
+    for counters in runs.values():
+        if "cycles" not in counters and "wheel_cycles" in counters:
+            counters["cycles"] = counters["wheel_cycles"]
+    return runs
+
+
+def estimate(counters, costs, duration_s, backlight_s):
+    """Per-component charge in µAh."""
+    duration_s = counters["duration_ms"] / 1000.0 if "duration_ms" in counters else duration_s
+    wakeups = counters.get("wakeups", 0)
+    cycles = counters.get("cycles") or wakeups * costs["cycles_per_wakeup"]
+    parts = {
+        "sleep": costs["sleep_ua"] / 1000.0 * (duration_s or 0) * UAH_PER_MA_SECOND,
+        "cpu": costs["cpu_active_ma"] * cycles / costs["cpu_hz"] * UAH_PER_MA_SECOND,
+        "wakeups": wakeups * costs["wakeup_uah"],
+        "display": counters.get("frames", 0) * costs["frame_uah"] + counters.get("pixels", 0) * costs["pixel_uah"],
+        "vibration": costs["vibe_ma"] * counters.get("vibe_ms", 0) / 1000.0 * UAH_PER_MA_SECOND,
+        "backlight": costs["backlight_ma"] * backlight_s * UAH_PER_MA_SECOND,
+    }
+    return parts, duration_s
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("logs", nargs="+")
+    parser.add_argument("--costs", default=COSTS, help="per-operation costs (default tools/energy_costs.json)")
+    parser.add_argument("--duration", type=float, help="seconds the logged session ran, for non-bench logs")
+    parser.add_argument("--backlight", type=float, default=0.0, help="seconds the backlight was on")
+    args = parser.parse_args()
+
+    with open(args.costs) as costs_file:
+        costs = json.load(costs_file)
+
+    runs = {}
+    for path in args.logs:
+        runs.update(parse(path))
+    if not runs:
+        sys.exit("no stats in the logs")
+
+    components = ["sleep", "cpu", "wakeups", "display", "vibration", "backlight"]
+    print("%-32s" % "run" + "".join("%11s" % c for c in components) + "%11s%12s" % ("mAh", "mAh/hour"))
+    for name, counters in runs.items():
+        parts, duration_s = estimate(counters, costs, args.duration, args.backlight)
+        total = sum(parts.values()) / 1000.0
+        per_hour = "%12.4f" % (total * 3600.0 / duration_s) if duration_s else "%12s" % "-"
+        print("%-32s" % name[-32:] + "".join("%11.3f" % (parts[c] / 1000.0) for c in components)
+              + "%11.4f" % total + per_hour)
+        if duration_s:
+            hours = costs["battery_mah"] / (total * 3600.0 / duration_s)
+            print("%-32s battery would last %.0f hours at this rate" % ("", hours))
+
+
+if __name__ == "__main__":
+    main()
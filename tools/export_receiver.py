@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Stand-in for the phone end of the session export (see src/export.h).
+
+Decodes the EXPORT_KEY_FRAMES payloads the watch sends, drops sessions
+it has already seen (a lost acknowledgement makes the watch resend; a
+session is known by the app launch it came from and its sequence number)
+and reports frame efficiency and decode throughput.
+
+Input is one message per line as hex, which is what a phone-side
+logger or a packet capture boils down to easily:
+
+  export_receiver.py capture.txt
+  export_receiver.py --synthesize 10000 > capture.txt   # made-up load
+"""
+
+import argparse
+import random
+import struct
+import sys
+import time
+
+FRAME_SIZE = 32
+FRAME_SESSION = 1
+FRAME_LAPS = 2
+FLAG_PROGRAM = 2
+LAPS_PER_FRAME = 14
+
+SESSION = struct.Struct("<BBHIHHHBBIIBI3x")
+LAPS = struct.Struct("<BBH%dH" % LAPS_PER_FRAME)
+# Bytes of a session frame that carry something, header included.
+SESSION_USED = SESSION.size - 3
+
+
+def decode(message, sessions, seen):
+    """Decode one message. Returns the number of payload bytes used."""
+    used = 0
+    current = None
+    for offset in range(0, len(message) - FRAME_SIZE + 1, FRAME_SIZE):
+        frame = message[offset:offset + FRAME_SIZE]
+        if frame[0] == FRAME_SESSION:
+            (_, flags, sequence, start, round_seconds, warning_seconds, rest_seconds,
+             round_count, rounds_done, elapsed, paused, lap_count, launch) = SESSION.unpack(frame)
+            used += SESSION_USED
+            current = None
+            if (launch, sequence) in seen:
+                continue
+            seen.add((launch, sequence))
+            current = {
+                "launch": launch, "sequence": sequence, "start": start, "program": bool(flags & FLAG_PROGRAM),
+                "round": round_seconds, "warning": warning_seconds,
+                "rest": rest_seconds, "round_count": round_count, "rounds_done": rounds_done,
+                "elapsed": elapsed / 10.0, "paused": paused / 10.0, "lap_count": lap_count, "laps": [],
+            }
+            sessions.append(current)
+        elif frame[0] == FRAME_LAPS:
+            fields = LAPS.unpack(frame)
+            first, sequence, laps = fields[1], fields[2], fields[3:]
+            if current is None or current["sequence"] != sequence:
+                continue
+            count = min(LAPS_PER_FRAME, current["lap_count"] - first)
+            current["laps"].extend(lap / 10.0 for lap in laps[:count])
+            used += 4 + 2 * count
+        else:
+            raise ValueError("unknown frame kind %d at offset %d" % (frame[0], offset))
+    return used
+
+
+def synthesize(count, batch_bytes=240):
+    """Messages the way export.c would batch them, for offline load."""
+    rng = random.Random(1)
+    start = launch = 40000000
+    message, sequence = b"", 0
+    for _ in range(count):
+        # Now and then the app restarts and its sequence numbers with it.
+        if rng.random() < 0.01:
+            launch, sequence = start, 0
+        # Timers running side by side finish out of start order.
+        start += rng.randint(-1800, 86400)
+        laps = [rng.randint(100, 3000) for _ in range(rng.choice((0, 0, 3, 10, 28)))]
+        size = FRAME_SIZE * (1 + (len(laps) + LAPS_PER_FRAME - 1) // LAPS_PER_FRAME)
+        if message and len(message) + size > batch_bytes:
+            yield message
+            message = b""
+        message += SESSION.pack(FRAME_SESSION, 0, sequence & 0xFFFF, start, 180, 30, 60, 12,
+                                rng.randint(0, 12), rng.randint(0, 36000), rng.randint(0, 600), len(laps), launch)
+        for first in range(0, len(laps), LAPS_PER_FRAME):
+            chunk = laps[first:first + LAPS_PER_FRAME]
+            message += LAPS.pack(FRAME_LAPS, first, sequence & 0xFFFF, *(chunk + [0] * (LAPS_PER_FRAME - len(chunk))))
+        sequence += 1
+    if message:
+        yield message
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", type=argparse.FileType("r"), default=sys.stdin)
+    parser.add_argument("--synthesize", type=int, metavar="N", help="print N made-up sessions as hex and exit")
+    parser.add_argument("--quiet", action="store_true", help="only print the summary")
+    args = parser.parse_args()
+
+    if args.synthesize:
+        for message in synthesize(args.synthesize):
+            print(message.hex())
+        return
+
+    messages = [bytes.fromhex(line.strip()) for line in args.capture if line.strip()]
+    sessions, seen = [], set()
+    used = 0
+    began = time.perf_counter()
+    for message in messages:
+        used += decode(message, sessions, seen)
+    took = time.perf_counter() - began
+
+    if not args.quiet:
+        for session in sessions:
+            print(session)
+    total = sum(len(message) for message in messages)
+    frames = total // FRAME_SIZE
+    print("%d messages, %d frames, %d sessions" % (len(messages), frames, len(sessions)), file=sys.stderr)
+    if total:
+        print("frame efficiency %.1f%% (%d of %d bytes carry data)" % (100.0 * used / total, used, total),
+              file=sys.stderr)
+    if took > 0:
+        print("decoded %.0f frames/s, %.2f MB/s" % (frames / took, total / took / 1e6), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""Work out which glyphs each font resource actually has to render.
+
+Reads the C sources, follows every string that can end up in a text
+layer back to the font that layer uses and compares the result with
+the characterRegex sets in resources/src/resource_map.json.
+
+  font_subset.py           report, exit 1 if a rendered glyph is missing
+  font_subset.py --write   rewrite the characterRegex sets to the minimum
+
+Strings reach a layer through text_layer_set_text(), through helpers
+that wrap text_layer_init/set_font/set_text (like config.c's
+init_text_layer), or through char buffers that are initialised,
+strcpy'd or memcpy'd from literals or other buffers. Buffers passed to
+itoa1/itoa2/format_lap pick up the digits (and punctuation) those write.
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+RESOURCE_MAP = os.path.join(ROOT, "resources", "src", "resource_map.json")
+
+STRING = r'"(?:[^"\\]|\\.)*"'
+DIGITS = set("0123456789")
+# What the helpers in common.c write into a buffer besides digits.
+WRITERS = {"itoa1": DIGITS, "itoa2": DIGITS, "format_lap": DIGITS | set(":.")}
+
+
+def strip_comments(source):
+    source = re.sub(r"/\*.*?\*/", " ", source, flags=re.S)
+    return re.sub(r"//[^\n]*", " ", source)
+
+
+def unquote(literal):
+    return bytes(literal[1:-1], "utf-8").decode("unicode_escape")
+
+
+def literals(text):
+    return "".join(unquote(match) for match in re.findall(STRING, text))
+
+
+def base_name(expression):
+    """The variable an argument like &lap_layers[i].layer or buf[0][4] refers to."""
+    match = re.match(r"\s*&?\s*\(?\s*(\w+)", expression)
+    return match.group(1) if match else None
+
+
+def split_args(text):
+    args, depth, current, in_string = [], 0, "", False
+    for index, char in enumerate(text):
+        if in_string:
+            current += char
+            if char == '"' and text[index - 1] != "\\":
+                in_string = False
+            continue
+        if char == '"':
+            in_string = True
+        elif char in "([{":
+            depth += 1
+        elif char in ")]}":
+            if depth == 0:
+                break
+            depth -= 1
+        elif char == "," and depth == 0:
+            args.append(current.strip())
+            current = ""
+            continue
+        current += char
+    args.append(current.strip())
+    return args
+
+
+def calls(source, name):
+    for match in re.finditer(r"\b%s\s*\(" % name, source):
+        yield split_args(source[match.end():])
+
+
+class Sources:
+    def __init__(self, paths):
+        self.files = {path: strip_comments(open(path).read()) for path in paths}
+        self.macros = {}
+        self.fonts = {}      # (file, variable) -> resource
+        self.layer_fonts = {}  # (file, layer) -> resource
+        self.layer_texts = {}  # (file, layer) -> (characters, buffers)
+        self.buffers = {}    # buffer -> characters
+        self.copies = []     # (destination, source) buffer pairs
+        for source in self.files.values():
+            for name, value in re.findall(r"#define\s+(\w+)\s+(RESOURCE_ID_\w+)", source):
+                self.macros[name] = value
+        for path, source in self.files.items():
+            self.scan(path, source)
+        self.propagate()
+
+    def resource(self, name):
+        name = self.macros.get(name, name)
+        return name[len("RESOURCE_ID_"):] if name.startswith("RESOURCE_ID_") else None
+
+    def add_text(self, path, layer, expression):
+        characters, buffers = self.layer_texts.setdefault((path, layer), [set(), set()])
+        characters.update(literals(expression))
+        expression = re.sub(STRING, " ", expression)
+        buffers.update(re.findall(r"\b([A-Za-z_]\w*)\b", expression))
+
+    def scan(self, path, source):
+        for variable, handle in re.findall(
+                r"(\w+)\s*=\s*fonts_load_custom_font\s*\(\s*resource_get_handle\s*\(\s*(\w+)\s*\)\s*\)", source):
+            self.fonts[(path, variable)] = self.resource(handle)
+
+        for args in calls(source, "text_layer_set_font"):
+            if len(args) == 2 and (path, args[1]) in self.fonts:
+                self.layer_fonts[(path, base_name(args[0]))] = self.fonts[(path, args[1])]
+        for args in calls(source, "text_layer_set_text"):
+            if len(args) == 2:
+                self.add_text(path, base_name(args[0]), args[1])
+
+        # Helpers taking a TextLayer * and the text to put in it.
+        for match in re.finditer(r"\b\w+\s+(\w+)\s*\(([^)]*TextLayer\s*\*[^)]*)\)\s*\{", source):
+            name, params = match.group(1), [p.split()[-1].lstrip("*") for p in match.group(2).split(",")]
+            body = source[match.end():source.find("\n}", match.end())]
+            font = text = layer = None
+            for args in calls(body, "text_layer_set_font"):
+                if args[0] in params and (path, args[1]) in self.fonts:
+                    layer, font = params.index(args[0]), self.fonts[(path, args[1])]
+            for args in calls(body, "text_layer_set_text"):
+                if args[0] in params and args[1] in params:
+                    layer, text = params.index(args[0]), params.index(args[1])
+            if layer is None:
+                continue
+            for args in calls(source, name):
+                if len(args) != len(params) or args[0].startswith("TextLayer"):
+                    continue
+                target = base_name(args[layer])
+                if font:
+                    self.layer_fonts[(path, target)] = font
+                if text is not None:
+                    self.add_text(path, target, args[text])
+
+        for name, initialiser in re.findall(r"\bchar\s+(\w+)\s*(?:\[[^\]]*\])+\s*=\s*([^;]+);", source):
+            self.buffers.setdefault(name, set()).update(literals(initialiser))
+        for function in ("strcpy", "memcpy"):
+            for args in calls(source, function):
+                destination = base_name(args[0])
+                if re.fullmatch(STRING, args[1]):
+                    self.buffers.setdefault(destination, set()).update(unquote(args[1]))
+                else:
+                    self.copies.append((destination, base_name(args[1])))
+        for name, characters in WRITERS.items():
+            for args in calls(source, name):
+                self.buffers.setdefault(base_name(args[-1]), set()).update(characters)
+        for name, character in re.findall(r"\b(\w+)\s*(?:\[[^\]]*\])+\s*=\s*'(\\?.)'", source):
+            self.buffers.setdefault(name, set()).update(unquote('"%s"' % character))
+
+    def propagate(self):
+        changed = True
+        while changed:
+            changed = False
+            for destination, source in self.copies:
+                extra = self.buffers.get(source, set()) - self.buffers.get(destination, set())
+                if extra:
+                    self.buffers.setdefault(destination, set()).update(extra)
+                    changed = True
+
+    def glyphs(self):
+        fonts = {}
+        for key, (characters, buffers) in self.layer_texts.items():
+            font = self.layer_fonts.get(key)
+            if not font:
+                continue
+            rendered = set(characters)
+            for buffer in buffers:
+                rendered |= self.buffers.get(buffer, set())
+            fonts.setdefault(font, set()).update(rendered)
+        return fonts
+
+
+def regex_characters(regex):
+    body = regex[1:-1] if regex.startswith("[") and regex.endswith("]") else regex
+    characters, index = set(), 0
+    while index < len(body):
+        char = body[index]
+        if char == "\\" and index + 1 < len(body):
+            char = body[index + 1]
+            index += 1
+        if index + 2 < len(body) and body[index + 1] == "-":
+            characters.update(chr(code) for code in range(ord(char), ord(body[index + 2]) + 1))
+            index += 3
+            continue
+        characters.add(char)
+        index += 1
+    return characters
+
+
+def character_regex(characters):
+    characters = set(characters)
+    parts = []
+    for first, last in (("0", "9"), ("A", "Z"), ("a", "z")):
+        span = set(chr(code) for code in range(ord(first), ord(last) + 1))
+        if span <= characters:
+            parts.append(first + "-" + last)
+            characters -= span
+    escaped = ["\\" + char if char in "\\]-^" else char for char in sorted(characters)]
+    return "[" + "".join(escaped[:1] + parts + escaped[1:]) + "]"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--write", action="store_true", help="rewrite resource_map.json with the minimal sets")
+    args = parser.parse_args()
+
+    text = open(RESOURCE_MAP).read()
+    resource_map = json.loads(text)
+    rendered = Sources(sorted(glob.glob(os.path.join(ROOT, "src", "*.c")))).glyphs()
+
+    missing = False
+    for media in resource_map["media"]:
+        if media["type"] != "font":
+            continue
+        name = media["defName"]
+        needed = rendered.get(name, set())
+        have = regex_characters(media.get("characterRegex", ""))
+        lacking, unused = needed - have, have - needed
+        print("%s: %d glyphs needed, %d in the resource map" % (name, len(needed), len(have)))
+        if lacking:
+            missing = True
+            print("  missing: %s" % "".join(sorted(lacking)))
+        if unused:
+            print("  unused: %s" % "".join(sorted(unused)))
+        if args.write and needed:
+            # Edit the text in place so the rest of the file stays as it was.
+            pattern = r'("characterRegex"\s*:\s*")(?:[^"\\]|\\.)*("\s*,\s*"defName"\s*:\s*"%s")' % name
+            replacement = json.dumps(character_regex(needed))[1:-1]
+            text = re.sub(pattern, lambda match: match.group(1) + replacement + match.group(2), text)
+
+    if args.write:
+        with open(RESOURCE_MAP, "w") as output:
+            output.write(text)
+    elif missing:
+        sys.exit("some strings would render glyphs their font doesn't have")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""Report how much flash and RAM each module takes, and check it against budgets.
+
+Run it after a build. Every object file under build/src counts as one
+module; its section sizes come from `size` and its biggest symbols
+from `nm`. The linked app is checked against the platform limit, and a
+ROUNDTIMER_STATS log adds the stack high-water mark (max_stack):
+
+  footprint.py                                 tables and budget check
+  footprint.py --log app.log                   ... plus the stack
+  footprint.py --write-budgets --headroom 10   budget today's sizes + 10%
+
+Flash is text + data (data's initial values ship with the app), RAM is
+data + bss. On this platform the whole app is loaded into RAM, so the
+app limit applies to text + data + bss together.
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BUDGETS = os.path.join(ROOT, "tools", "footprint_budgets.json")
+
+# nm's symbol types, by where the symbol ends up.
+FLASH_TYPES = set("TtRrDd")
+RAM_TYPES = set("DdBbCc")
+
+
+def section_sizes(size, path):
+    """(text, data, bss) of one object or the linked app."""
+    output = subprocess.check_output([size, path], universal_newlines=True).splitlines()
+    text, data, bss = output[1].split()[:3]
+    return int(text), int(data), int(bss)
+
+
+def symbols(nm, path):
+    """[(size, type, name)] for every symbol that takes up space."""
+    found = []
+    output = subprocess.check_output([nm, "-S", "-t", "d", path], universal_newlines=True)
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) != 4:
+            continue
+        size, kind, name = int(fields[1]), fields[2], fields[3]
+        if size and (kind in FLASH_TYPES or kind in RAM_TYPES):
+            found.append((size, kind, name))
+    return found
+
+
+def module_name(path):
+    # waf names them stopwatch.c.1.o and so on.
+    return os.path.basename(path).split(".")[0]
+
+
+def stack_from_log(path):
+    with open(path) as log:
+        for line in log:
+            match = re.search(r"\{.*\}", line)
+            if not match:
+                continue
+            try:
+                record = json.loads(match.group(0))
+            except ValueError:
+                continue
+            if record.get("stat") == "max_stack":
+                return record["value"]
+    return None
+
+
+def check(budget, value, what, over):
+    if budget is None:
+        return
+    if value > budget:
+        over.append("%s: %d bytes, budget %d (%d over)" % (what, value, budget, value - budget))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--build", default=os.path.join(ROOT, "build"), help="waf build directory")
+    parser.add_argument("--elf", help="linked app (default BUILD/pebble-app.elf)")
+    parser.add_argument("--log", help="app log of a ROUNDTIMER_STATS build, for the stack")
+    parser.add_argument("--budgets", default=BUDGETS)
+    parser.add_argument("--write-budgets", action="store_true", help="budget every module at its current size")
+    parser.add_argument("--headroom", type=float, default=10.0, help="percent added by --write-budgets (default 10)")
+    parser.add_argument("--symbols", type=int, default=15, metavar="N", help="show the N biggest symbols (default 15)")
+    parser.add_argument("--prefix", help="toolchain prefix (default arm-none-eabi- if it's on the path)")
+    args = parser.parse_args()
+
+    prefix = args.prefix
+    if prefix is None:
+        prefix = "arm-none-eabi-" if shutil.which("arm-none-eabi-nm") else ""
+    nm, size = prefix + "nm", prefix + "size"
+
+    objects = sorted(glob.glob(os.path.join(args.build, "src", "**", "*.o"), recursive=True))
+    if not objects:
+        sys.exit("no object files under %s/src; build first" % args.build)
+
+    modules, everything = {}, []
+    for path in objects:
+        text, data, bss = section_sizes(size, path)
+        name = module_name(path)
+        totals = modules.setdefault(name, {"text": 0, "data": 0, "bss": 0})
+        totals["text"] += text
+        totals["data"] += data
+        totals["bss"] += bss
+        everything.extend((symbol_size, kind, "%s:%s" % (name, symbol)) for symbol_size, kind, symbol in symbols(nm, path))
+    for totals in modules.values():
+        totals["flash"] = totals["text"] + totals["data"]
+        totals["ram"] = totals["data"] + totals["bss"]
+
+    print("%-14s%8s%8s%8s%8s%8s" % ("module", "flash", "ram", "text", "data", "bss"))
+    for name, totals in sorted(modules.items(), key=lambda item: -(item[1]["flash"] + item[1]["bss"])):
+        print("%-14s%8d%8d%8d%8d%8d" % (name, totals["flash"], totals["ram"], totals["text"], totals["data"], totals["bss"]))
+
+    if args.symbols:
+        print()
+        print("%8s  %s  %s" % ("bytes", "type", "symbol"))
+        for symbol_size, kind, name in sorted(everything, reverse=True)[:args.symbols]:
+            print("%8d  %-4s  %s" % (symbol_size, "ram" if kind in "BbCc" else "data" if kind in "Dd" else "code" if kind in "Tt" else "ro", name))
+
+    elf = args.elf or os.path.join(args.build, "pebble-app.elf")
+    app = None
+    if os.path.exists(elf):
+        text, data, bss = section_sizes(size, elf)
+        app = text + data + bss
+        print()
+        print("app: %d bytes (text %d, data %d, bss %d)" % (app, text, data, bss))
+
+    stack = None
+    if args.log:
+        stack = stack_from_log(args.log)
+        print("stack: %s" % ("not in the log" if stack is None else "%d bytes below handle_init" % stack))
+
+    budgets = {}
+    if os.path.exists(args.budgets):
+        with open(args.budgets) as budget_file:
+            budgets = json.load(budget_file)
+
+    if args.write_budgets:
+        scale = 1 + args.headroom / 100.0
+        budgets["modules"] = dict((name, {"flash": int(totals["flash"] * scale + 0.5), "ram": int(totals["ram"] * scale + 0.5)})
+                                  for name, totals in modules.items())
+        with open(args.budgets, "w") as output:
+            json.dump(budgets, output, indent=2, sort_keys=True)
+            output.write("\n")
+        return
+
+    over = []
+    for name, totals in sorted(modules.items()):
+        budget = budgets.get("modules", {}).get(name)
+        if budget is None:
+            if budgets.get("modules"):
+                print("%s: no budget" % name)
+            continue
+        check(budget.get("flash"), totals["flash"], "%s flash" % name, over)
+        check(budget.get("ram"), totals["ram"], "%s ram" % name, over)
+    if app is not None:
+        check(budgets.get("app"), app, "app", over)
+    if stack is not None:
+        check(budgets.get("stack"), stack, "stack", over)
+    if over:
+        print()
+        for line in over:
+            print(line)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
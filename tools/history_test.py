@@ -0,0 +1,34 @@
+#!/usr/bin/env python3
+"""Build and run the session history test on the host (tools/host/history_test.c).
+
+Compiles src/session.c and src/history.c against the stub SDK headers in
+tools/host and checks the history accessors and per-program totals the
+history window shows. It exits 1 if any check fails.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCES = [os.path.join(ROOT, "src", name) for name in ("session.c", "history.c")]
+SOURCES.append(os.path.join(ROOT, "tools", "host", "history_test.c"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"))
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as build:
+        binary = os.path.join(build, "history_test")
+        subprocess.check_call([args.cc, "-O2", "-std=gnu99", "-Wall",
+                               "-I", os.path.join(ROOT, "tools", "host"), "-I", os.path.join(ROOT, "src"),
+                               "-o", binary] + SOURCES)
+        sys.exit(subprocess.call([binary]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,110 @@
+/*
+ * Pebble Round Timer - the bench on the host
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Runs the whole app, built with ROUNDTIMER_BENCH, on tools/host/pebble_host.c.
+// Build and run it through tools/bench_host.py, which hands the log to
+// tools/bench_compare.py.
+//
+// The app logs its own counts. On top of those this logs, as
+// {"host": ...} lines, the host CPU time each scenario took and the
+// deepest the stack got over the whole run. Both are the host's, not
+// the watch's: pointers are twice the size here and the compiler isn't
+// the same, so they only compare with other host runs.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include "pebble_host.h"
+
+void pbl_main(void *params);
+
+// Painted below main before the app starts. The app never comes near
+// this on the watch, so all of it is room to spare.
+#define STACK_PAINT_BYTES (256 * 1024)
+#define STACK_PAINT 0xA5
+
+static uintptr_t paint_low;
+static bool done = false;
+static uint64_t scenario_began;
+
+static uint64_t cpu_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+static void __attribute__((noinline)) stack_paint() {
+    volatile uint8_t area[STACK_PAINT_BYTES];
+    for(size_t i = 0; i < sizeof(area); ++i) area[i] = STACK_PAINT;
+    paint_low = (uintptr_t)area;
+}
+
+static size_t stack_used() {
+    size_t untouched = 0;
+    volatile uint8_t *p = (volatile uint8_t *)paint_low;
+    while(untouched < STACK_PAINT_BYTES && p[untouched] == STACK_PAINT) ++untouched;
+    return STACK_PAINT_BYTES - untouched;
+}
+
+// Every scenario ends with {"bench":"<name>",...}, and the run with {"bench":"done"}.
+static void bench_log(const char *message) {
+    static const char prefix[] = "{\"bench\":\"";
+    if(strncmp(message, prefix, sizeof(prefix) - 1)) return;
+    const char *name = message + sizeof(prefix) - 1;
+    if(!strncmp(name, "done\"", 5)) {
+        done = true;
+        host_quit();
+        return;
+    }
+    uint64_t now = cpu_ns();
+    printf("{\"host\":\"%.*s\",\"cpu_ns\":%llu}\n", (int)strcspn(name, "\""), name,
+        (unsigned long long)(now - scenario_began));
+    scenario_began = now;
+}
+
+int main(int argc, char **argv) {
+    // The bench covers a few days of simulated time; this is plenty.
+    uint32_t limit_hours = 240;
+    int opt;
+    while((opt = getopt(argc, argv, "l:")) != -1) {
+        switch(opt) {
+        case 'l': limit_hours = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-l simulated hours before giving up]\n", argv[0]);
+            return 2;
+        }
+    }
+    host_stop_at = limit_hours * 3600000u;
+    host_log_hook = bench_log;
+
+    stack_paint();
+    scenario_began = cpu_ns();
+    pbl_main(NULL);
+    printf("{\"host\":\"run\",\"peak_stack\":%lu}\n", (unsigned long)stack_used());
+
+    if(!done) {
+        fprintf(stderr, "the bench didn't finish within %lu simulated hours\n", (unsigned long)limit_hours);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Pebble Round Timer - session history test on the host
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Runs sessions through src/session.c into src/history.c and checks what
+// the accessors and per-program totals the history window reads say
+// about them: newest first, the ring wrapping, rounds timed without their
+// pauses, weekly totals that only a later week starts over, and the least
+// recently used program making way. Build and run it through
+// tools/history_test.py.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "common.h"
+#include "timers.h"
+#include "session.h"
+#include "round_timer.h"
+#include "program.h"
+#include "history.h"
+
+#define WEEK HISTORY_WEEK_SECONDS
+
+time_t round_time;
+time_t warning_time;
+time_t rest_time;
+int total_round_count;
+
+static time_t seconds = 0;
+static int exported = 0;
+static int failures = 0;
+
+#define CHECK(condition) check(condition, #condition, __LINE__)
+
+static void check(bool passed, const char *what, int line) {
+    if(passed) return;
+    printf("line %d: %s\n", line, what);
+    ++failures;
+}
+
+// What session.c needs from the rest of the app.
+time_t get_pebble_seconds() { return seconds; }
+bool program_loaded() { return false; }
+int program_rounds() { return 0; }
+time_t program_work(time_t elapsed) { return 0; }
+void export_queue(SessionRecord *session) { ++exported; }
+void app_log(uint8_t level, const char *file, int line, const char *fmt, ...) {}
+
+int current_round_count(time_t elapsed) {
+    time_t full_round = round_time + rest_time;
+    return full_round > 0 && elapsed > full_round ? (elapsed - 1) / full_round : 0;
+}
+
+static void configure(time_t round, time_t rest, int count) {
+    round_time = round;
+    warning_time = 0;
+    rest_time = rest;
+    total_round_count = count;
+}
+
+// A session of the current settings starting at start, running for
+// elapsed ms with paused ms of pauses, its rounds each checked a little
+// after they ended, the way the boundary timer would.
+static void run_session(time_t start, time_t elapsed, time_t paused) {
+    SessionRecord session;
+    seconds = start;
+    session_begin(&session);
+    time_t full_round = round_time + rest_time;
+    for(time_t end = full_round; full_round && end < elapsed; end += full_round) {
+        session_round(&session, current_round_count(end + 1), end + 1);
+    }
+    session_finish(&session, elapsed, paused);
+}
+
+int main() {
+    CHECK(history_count() == 0);
+
+    // Rounds are timed on elapsed time, so pauses don't come into it.
+    configure(60000, 15000, 10);
+    SessionRecord session;
+    seconds = 10 * WEEK;
+    session_begin(&session);
+    session_round(&session, 1, 75000);
+    session_round(&session, 2, 150400);
+    session_round(&session, 4, 300000); // missed one, so neither is timed
+    session_round(&session, 5, 375200);
+    session_finish(&session, 380000, 500000);
+    CHECK(history_count() == 1);
+    CHECK(history_best_round(0) == 750);
+    CHECK(history_rounds(0) == 5);
+    CHECK(history_work(0) == 5 * 600 + 50);
+    CHECK(history_rest(0) == 3800 - history_work(0));
+    CHECK(history_start(0) == 10 * WEEK);
+    CHECK(exported == 1);
+
+    HistoryProgram *program = history_program(history_program_id(0));
+    CHECK(program->sessions == 1);
+    CHECK(program->best_round == 750);
+    CHECK(program->most_rounds == 5);
+    CHECK(program->week == 10);
+    CHECK(program->week_sessions == 1);
+
+    // Newest first, and a second session of the same settings adds up.
+    run_session(10 * WEEK + 100, 160000, 0);
+    CHECK(history_count() == 2);
+    CHECK(history_start(0) == 10 * WEEK + 100);
+    CHECK(history_start(1) == 10 * WEEK);
+    CHECK(history_program_id(0) == history_program_id(1));
+    CHECK(program->sessions == 2);
+    CHECK(program->work == history_work(0) + history_work(1));
+    CHECK(program->rest == history_rest(0) + history_rest(1));
+    CHECK(program->week_sessions == 2);
+    CHECK(program->week_work == program->work);
+
+    // A later week starts the week over; one that finished late from an
+    // earlier week counts towards the program but not the week.
+    run_session(11 * WEEK, 90000, 0);
+    CHECK(program->week == 11);
+    CHECK(program->week_sessions == 1);
+    CHECK(program->week_work == history_work(0));
+    run_session(10 * WEEK + 200, 90000, 0);
+    CHECK(program->week == 11);
+    CHECK(program->week_sessions == 1);
+    CHECK(program->sessions == 4);
+
+    // Different settings are a different program.
+    configure(30000, 10000, 5);
+    run_session(11 * WEEK + 100, 100000, 0);
+    uint8_t short_rounds = history_program_id(0);
+    CHECK(short_rounds != history_program_id(1));
+    CHECK(history_program(short_rounds)->best_round == 400);
+    CHECK(history_program_count() == 2);
+
+    // Running out of programs, the one used longest ago goes and its
+    // sessions still in the history lose it.
+    uint8_t first = history_program_id(1);
+    for(int i = 0; i < HISTORY_PROGRAMS - 1; ++i) {
+        configure(20000 + i * 1000, 5000, 3);
+        run_session(12 * WEEK + i, 30000, 0);
+    }
+    CHECK(history_program_count() == HISTORY_PROGRAMS);
+    bool orphaned = true;
+    for(int i = 0; i < history_count(); ++i) {
+        if(history_start(i) / WEEK == 10 && history_program_id(i) != HISTORY_NO_PROGRAM) orphaned = false;
+        if(history_start(i) == 11 * WEEK + 100) CHECK(history_program_id(i) == short_rounds);
+    }
+    CHECK(orphaned);
+    CHECK(history_program(first)->sessions == 1);
+
+    // The ring keeps the latest HISTORY_SIZE, newest first.
+    configure(60000, 15000, 10);
+    for(int i = 0; i < HISTORY_SIZE + 5; ++i) run_session(13 * WEEK + i, 1000, 0);
+    CHECK(history_count() == HISTORY_SIZE);
+    CHECK(history_start(0) == 13 * WEEK + HISTORY_SIZE + 4);
+    CHECK(history_start(HISTORY_SIZE - 1) == 13 * WEEK + 5);
+
+    printf("%d sessions, %s\n", exported, failures ? "FAILED" : "all checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+// Just enough of the Pebble SDK 1.x headers (the app half) to build the
+// modules in src/ with a desktop compiler, for the host tools in tools/.
+#pragma once
+typedef void* AppContextRef;
+typedef uint32_t AppTimerHandle;
+AppTimerHandle app_timer_send_event(AppContextRef, uint32_t, uint32_t);
+bool app_timer_cancel_event(AppContextRef, AppTimerHandle);
+typedef void (*PebbleAppInitEventHandler)(AppContextRef);
+typedef void (*PebbleAppTimerHandler)(AppContextRef, AppTimerHandle, uint32_t);
+typedef struct { uint16_t inbound, outbound; } AppMessageBufferSizes;
+typedef struct { AppMessageBufferSizes buffer_sizes; } PebbleAppMessagingInfo;
+typedef struct { PebbleAppInitEventHandler init_handler, deinit_handler; PebbleAppTimerHandler timer_handler; PebbleAppMessagingInfo messaging_info; } PebbleAppHandlers;
+void app_event_loop(void*, PebbleAppHandlers*);
+typedef enum { APP_MSG_OK = 0, APP_MSG_SEND_TIMEOUT = 2, APP_MSG_SEND_REJECTED = 4, APP_MSG_NOT_CONNECTED = 8, APP_MSG_BUSY = 64 } AppMessageResult;
+typedef struct DictionaryIterator DictionaryIterator;
+typedef enum { DICT_OK = 0 } DictionaryResult;
+typedef struct { uint32_t key; uint8_t type; uint16_t length; union { uint8_t data[0]; } value[]; } Tuple;
+typedef void (*AppMessageOutSent)(DictionaryIterator*, void*);
+typedef void (*AppMessageOutFailed)(DictionaryIterator*, AppMessageResult, void*);
+typedef void (*AppMessageInReceived)(DictionaryIterator*, void*);
+typedef void (*AppMessageInDropped)(void*, AppMessageResult, void*);
+typedef struct { void *context; struct { AppMessageOutSent out_sent; AppMessageOutFailed out_failed; AppMessageInReceived in_received; AppMessageInDropped in_dropped; } callbacks; } AppMessageCallbacksNode;
+AppMessageResult app_message_register_callbacks(AppMessageCallbacksNode*);
+AppMessageResult app_message_out_get(DictionaryIterator**);
+AppMessageResult app_message_out_send(void);
+AppMessageResult app_message_out_release(void);
+DictionaryResult dict_write_data(DictionaryIterator*, uint32_t, const uint8_t*, uint16_t);
+DictionaryResult dict_write_uint8(DictionaryIterator*, uint32_t, uint8_t);
+uint32_t dict_write_end(DictionaryIterator*);
+Tuple *dict_find(DictionaryIterator*, uint32_t);
+enum { APP_LOG_LEVEL_ERROR=1, APP_LOG_LEVEL_WARNING=50, APP_LOG_LEVEL_INFO=100, APP_LOG_LEVEL_DEBUG=200 };
+void app_log(uint8_t, const char*, int, const char*, ...);
+#define APP_LOG(level, fmt, args...) app_log(level, __FILE__, __LINE__, fmt, ## args)
+#define PBL_APP_INFO(...) 
+#define APP_INFO_STANDARD_APP 0
+#define RESOURCE_ID_IMAGE_MENU_ICON 1
+#define RESOURCE_ID_IMAGE_BUTTON_LABELS 2
+#define RESOURCE_ID_FONT_DEJAVU_SANS_BOLD_SUBSET_30 3
+#define RESOURCE_ID_FONT_DEJAVU_SANS_SUBSET_18 4
+#define RESOURCE_ID_FONT_DEJAVU_SANS_SUBSET_22 5
+#define RESOURCE_ID_PROGRAM 6
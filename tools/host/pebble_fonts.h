@@ -0,0 +1,3 @@
+// Just enough of the Pebble SDK 1.x headers (the fonts) to build the
+// modules in src/ with a desktop compiler, for the host tools in tools/.
+#pragma once
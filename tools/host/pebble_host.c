@@ -0,0 +1,588 @@
+/*
+ * Pebble Round Timer - the SDK on the host
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// A stand-in for the Pebble SDK 1.x, enough to run the whole app on the
+// host. Time only moves when the next event is delivered, so a session
+// that takes an hour on the watch runs in as long as its handlers take.
+// Animations jump to their ends: they start after their delay and stop
+// after their duration, with nothing drawn in between. Drawing is in
+// tools/host/pebble_screen.c.
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "pebble_host.h"
+
+#define SCREEN_WIDTH 144
+#define SCREEN_HEIGHT 168
+#define STATUS_BAR_HEIGHT 16
+
+// 2013-06-01 12:00:00 UTC, when every run starts.
+#define HOST_EPOCH 1370088000
+
+// How long an app message takes to reach the phone and be acked.
+#define HOST_MESSAGE_MS 100
+
+#define MAX_TIMERS 32
+#define MAX_WINDOWS 8
+
+uint32_t host_ms = 0;
+uint32_t host_stop_at = 0;
+void (*host_log_hook)(const char *message) = NULL;
+void (*host_script)(void) = NULL;
+
+ResBankVersion APP_RESOURCES;
+
+static PebbleAppHandlers app_handlers;
+static int app_context;
+static bool quitting = false;
+
+typedef struct {
+    AppTimerHandle handle;
+    uint32_t due;
+    uint32_t cookie;
+} HostTimer;
+
+static HostTimer timers[MAX_TIMERS];
+static int timer_count = 0;
+static AppTimerHandle last_handle = 0;
+
+static Animation *animations = NULL;
+
+struct DictionaryIterator { uint16_t length; };
+static DictionaryIterator message;
+static AppMessageCallbacksNode *message_callbacks = NULL;
+static bool message_in_flight = false;
+static uint32_t message_acked_at;
+
+static Window *window_stack[MAX_WINDOWS];
+static int window_count = 0;
+
+// Event loop
+
+void app_event_loop(void *params, PebbleAppHandlers *handlers) {
+    (void)params;
+    app_handlers = *handlers;
+    if(app_handlers.init_handler) app_handlers.init_handler(&app_context);
+    host_screen_frame();
+    if(host_script) {
+        host_script();
+    } else {
+        while(!quitting && host_step()) {}
+    }
+    if(app_handlers.deinit_handler) app_handlers.deinit_handler(&app_context);
+}
+
+void host_quit(void) {
+    quitting = true;
+}
+
+static uint32_t animation_next_at(Animation *animation) {
+    uint32_t at = animation->scheduled_at + animation->delay_ms;
+    return animation->is_started ? at + animation->duration_ms : at;
+}
+
+static void unlink_animation(Animation *animation) {
+    for(Animation **a = &animations; *a; a = &(*a)->next) {
+        if(*a == animation) {
+            *a = animation->next;
+            break;
+        }
+    }
+    animation->next = NULL;
+    animation->is_scheduled = false;
+}
+
+bool host_step(void) {
+    int timer = -1;
+    Animation *animation = NULL;
+    uint32_t at = UINT32_MAX;
+    for(int i = 0; i < timer_count; ++i) {
+        if(timers[i].due < at) {
+            at = timers[i].due;
+            timer = i;
+        }
+    }
+    for(Animation *a = animations; a; a = a->next) {
+        if(animation_next_at(a) < at) {
+            at = animation_next_at(a);
+            animation = a;
+            timer = -1;
+        }
+    }
+    bool acked = message_in_flight && message_acked_at < at;
+    if(acked) at = message_acked_at;
+    if(at == UINT32_MAX) return false;
+    if(host_stop_at && at > host_stop_at) {
+        host_ms = host_stop_at;
+        return false;
+    }
+    if(at > host_ms) host_ms = at;
+
+    if(acked) {
+        message_in_flight = false;
+        if(message_callbacks && message_callbacks->callbacks.out_sent) {
+            message_callbacks->callbacks.out_sent(&message, message_callbacks->context);
+        }
+    } else if(animation && !animation->is_started) {
+        animation->is_started = true;
+        if(animation->update) animation->update(animation, false);
+        if(animation->handlers.started) animation->handlers.started(animation, animation->context);
+    } else if(animation) {
+        unlink_animation(animation);
+        if(animation->update) animation->update(animation, true);
+        if(animation->handlers.stopped) animation->handlers.stopped(animation, true, animation->context);
+    } else {
+        HostTimer fired = timers[timer];
+        timers[timer] = timers[--timer_count];
+        if(app_handlers.timer_handler) app_handlers.timer_handler(&app_context, fired.handle, fired.cookie);
+    }
+    host_screen_frame();
+    return true;
+}
+
+void host_run_for(uint32_t ms) {
+    host_stop_at = host_ms + ms;
+    while(!quitting && host_step()) {}
+    host_ms = host_stop_at;
+    host_stop_at = 0;
+}
+
+void host_click(ButtonId button, bool long_click) {
+    Window *window = window_stack_get_top_window();
+    if(!window) return;
+    ClickConfig configs[NUM_BUTTONS];
+    ClickConfig *config[NUM_BUTTONS];
+    memset(configs, 0, sizeof(configs));
+    for(int i = 0; i < NUM_BUTTONS; ++i) config[i] = &configs[i];
+    if(window->click_config_provider) window->click_config_provider(config, window->click_config_context);
+    ClickHandler handler = long_click ? configs[button].long_click.handler : configs[button].click.handler;
+    if(handler) {
+        handler(&button, configs[button].context ? configs[button].context : window->click_config_context);
+    } else if(button == BUTTON_ID_BACK && !long_click) {
+        window_stack_pop(true);
+    }
+    host_screen_frame();
+}
+
+// App timers
+
+AppTimerHandle app_timer_send_event(AppContextRef ctx, uint32_t after_ms, uint32_t cookie) {
+    (void)ctx;
+    if(timer_count == MAX_TIMERS) return 0;
+    timers[timer_count].handle = ++last_handle;
+    timers[timer_count].due = host_ms + after_ms;
+    timers[timer_count].cookie = cookie;
+    ++timer_count;
+    return last_handle;
+}
+
+bool app_timer_cancel_event(AppContextRef ctx, AppTimerHandle handle) {
+    (void)ctx;
+    for(int i = 0; i < timer_count; ++i) {
+        if(timers[i].handle == handle) {
+            timers[i] = timers[--timer_count];
+            return true;
+        }
+    }
+    return false;
+}
+
+void get_time(PblTm *t) {
+    time_t now = HOST_EPOCH + host_ms / 1000;
+    struct tm tm;
+    gmtime_r(&now, &tm);
+    t->tm_sec = tm.tm_sec;
+    t->tm_min = tm.tm_min;
+    t->tm_hour = tm.tm_hour;
+    t->tm_mday = tm.tm_mday;
+    t->tm_mon = tm.tm_mon;
+    t->tm_year = tm.tm_year;
+    t->tm_wday = tm.tm_wday;
+    t->tm_yday = tm.tm_yday;
+    t->tm_isdst = 0;
+}
+
+void app_log(uint8_t level, const char *file, int line, const char *fmt, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    const char *name = strrchr(file, '/');
+    printf("%s:%d %s\n", name ? name + 1 : file, line, text);
+    (void)level;
+    if(host_log_hook) host_log_hook(text);
+}
+
+// Windows and layers
+
+static void layer_init(Layer *layer, GRect frame) {
+    memset(layer, 0, sizeof(*layer));
+    layer->frame = frame;
+    layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+    layer->clips = true;
+}
+
+void window_init(Window *window, const char *name) {
+    (void)name;
+    memset(window, 0, sizeof(*window));
+    layer_init(&window->layer, GRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT - STATUS_BAR_HEIGHT));
+    window->layer.window = window;
+    window->background_color = GColorWhite;
+}
+
+void window_set_background_color(Window *window, GColor color) {
+    window->background_color = color;
+}
+
+void window_set_fullscreen(Window *window, bool enabled) {
+    window->is_fullscreen = enabled;
+    int16_t height = enabled ? SCREEN_HEIGHT : SCREEN_HEIGHT - STATUS_BAR_HEIGHT;
+    window->layer.frame.size.h = window->layer.bounds.size.h = height;
+}
+
+void window_set_click_config_provider(Window *window, ClickConfigProvider provider) {
+    window->click_config_provider = provider;
+    window->click_config_context = window;
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+    window->window_handlers = handlers;
+}
+
+Layer *window_get_root_layer(Window *window) {
+    return &window->layer;
+}
+
+Window *window_stack_get_top_window(void) {
+    return window_count ? window_stack[window_count - 1] : NULL;
+}
+
+void window_stack_push(Window *window, bool animated) {
+    (void)animated;
+    Window *top = window_stack_get_top_window();
+    if(top == window) return;
+    for(int i = 0; i < window_count; ++i) {
+        if(window_stack[i] != window) continue;
+        memmove(&window_stack[i], &window_stack[i + 1], (window_count - i - 1) * sizeof(Window *));
+        --window_count;
+        break;
+    }
+    if(window_count == MAX_WINDOWS) return;
+    if(top && top->window_handlers.disappear) top->window_handlers.disappear(top);
+    window_stack[window_count++] = window;
+    if(!window->is_loaded) {
+        window->is_loaded = true;
+        if(window->window_handlers.load) window->window_handlers.load(window);
+    }
+    if(window->window_handlers.appear) window->window_handlers.appear(window);
+    host_screen_dirty(&window->layer);
+}
+
+Window *window_stack_pop(bool animated) {
+    (void)animated;
+    if(!window_count) return NULL;
+    Window *window = window_stack[--window_count];
+    if(window->window_handlers.disappear) window->window_handlers.disappear(window);
+    Window *top = window_stack_get_top_window();
+    if(top && top->window_handlers.appear) top->window_handlers.appear(top);
+    if(top) host_screen_dirty(&top->layer);
+    return window;
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+    child->parent = parent;
+    child->next_sibling = NULL;
+    Layer **last = &parent->first_child;
+    while(*last) last = &(*last)->next_sibling;
+    *last = child;
+    host_screen_dirty(child);
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+    host_screen_dirty(layer);
+    layer->frame = frame;
+    layer->bounds.size = frame.size;
+    host_screen_dirty(layer);
+}
+
+GRect layer_get_frame(Layer *layer) {
+    return layer->frame;
+}
+
+void layer_set_hidden(Layer *layer, bool hidden) {
+    if(layer->hidden == hidden) return;
+    layer->hidden = hidden;
+    host_screen_dirty(layer);
+}
+
+bool layer_get_hidden(Layer *layer) {
+    return layer->hidden;
+}
+
+void layer_mark_dirty(Layer *layer) {
+    host_screen_dirty(layer);
+}
+
+Window *layer_get_window(Layer *layer) {
+    while(layer->parent) layer = layer->parent;
+    return layer->window;
+}
+
+void text_layer_init(TextLayer *layer, GRect frame) {
+    memset(layer, 0, sizeof(*layer));
+    layer_init(&layer->layer, frame);
+    layer->text = "";
+    layer->text_color = GColorBlack;
+    layer->background_color = GColorWhite;
+    layer->text_alignment = GTextAlignmentLeft;
+    host_screen_init_text_layer(layer);
+}
+
+// The setters mark the layer dirty, as the SDK's do.
+void text_layer_set_background_color(TextLayer *layer, GColor color) {
+    layer->background_color = color;
+    host_screen_dirty(&layer->layer);
+}
+
+void text_layer_set_font(TextLayer *layer, GFont font) {
+    layer->font = font;
+    host_screen_dirty(&layer->layer);
+}
+
+void text_layer_set_text_color(TextLayer *layer, GColor color) {
+    layer->text_color = color;
+    host_screen_dirty(&layer->layer);
+}
+
+void text_layer_set_text(TextLayer *layer, const char *text) {
+    layer->text = text;
+    host_screen_dirty(&layer->layer);
+}
+
+void text_layer_set_text_alignment(TextLayer *layer, GTextAlignment alignment) {
+    layer->text_alignment = alignment;
+    host_screen_dirty(&layer->layer);
+}
+
+const char *text_layer_get_text(TextLayer *layer) {
+    return layer->text;
+}
+
+void scroll_layer_init(ScrollLayer *layer, GRect frame) {
+    layer_init(&layer->layer, frame);
+    layer_init(&layer->content_sublayer, GRect(0, 0, frame.size.w, frame.size.h));
+    layer_add_child(&layer->layer, &layer->content_sublayer);
+}
+
+void scroll_layer_add_child(ScrollLayer *layer, Layer *child) {
+    layer_add_child(&layer->content_sublayer, child);
+}
+
+void scroll_layer_set_content_size(ScrollLayer *layer, GSize size) {
+    layer_set_frame(&layer->content_sublayer, (GRect){ layer->content_sublayer.frame.origin, size });
+}
+
+void scroll_layer_set_content_offset(ScrollLayer *layer, GPoint offset, bool animated) {
+    (void)animated;
+    layer_set_frame(&layer->content_sublayer, (GRect){ offset, layer->content_sublayer.frame.size });
+}
+
+static void scroll_by(ScrollLayer *layer, int16_t distance) {
+    int16_t lowest = layer->layer.frame.size.h - layer->content_sublayer.frame.size.h;
+    int16_t y = layer->content_sublayer.frame.origin.y + distance;
+    if(y < lowest) y = lowest;
+    if(y > 0) y = 0;
+    layer_set_frame(&layer->content_sublayer, GRect(0, y, layer->content_sublayer.frame.size.w, layer->content_sublayer.frame.size.h));
+}
+
+static void scroll_up(ClickRecognizerRef recognizer, void *context) {
+    (void)recognizer;
+    scroll_by(context, 32);
+}
+
+static void scroll_down(ClickRecognizerRef recognizer, void *context) {
+    (void)recognizer;
+    scroll_by(context, -32);
+}
+
+static void scroll_click_config(ClickConfig **config, void *context) {
+    config[BUTTON_ID_UP]->click.handler = scroll_up;
+    config[BUTTON_ID_DOWN]->click.handler = scroll_down;
+    (void)context;
+}
+
+void scroll_layer_set_click_config_onto_window(ScrollLayer *layer, Window *window) {
+    window->click_config_provider = scroll_click_config;
+    window->click_config_context = layer;
+}
+
+// Resources
+
+void resource_init_current_app(ResBankVersion *version) {
+    (void)version;
+}
+
+// None of them are there, so no program is loaded.
+ResHandle resource_get_handle(uint32_t id) {
+    return id;
+}
+
+size_t resource_size(ResHandle handle) {
+    (void)handle;
+    return 0;
+}
+
+size_t resource_load(ResHandle handle, uint8_t *buffer, size_t max_length) {
+    (void)handle;
+    (void)buffer;
+    (void)max_length;
+    return 0;
+}
+
+void resource_load_byte_range(ResHandle handle, uint32_t start, uint8_t *buffer, size_t length) {
+    (void)handle;
+    (void)start;
+    memset(buffer, 0, length);
+}
+
+GFont fonts_load_custom_font(ResHandle handle) {
+    return (GFont)(uintptr_t)handle;
+}
+
+
+// Animations
+
+static void property_update(Animation *animation, bool finished) {
+    PropertyAnimation *property = (PropertyAnimation *)animation;
+    layer_set_frame(property->subject, finished ? property->values.to : property->values.from);
+}
+
+void property_animation_init_layer_frame(PropertyAnimation *animation, Layer *layer, GRect *from, GRect *to) {
+    memset(animation, 0, sizeof(*animation));
+    animation->animation.duration_ms = 250;
+    animation->animation.update = property_update;
+    animation->subject = layer;
+    animation->values.from = from ? *from : layer->frame;
+    animation->values.to = to ? *to : layer->frame;
+}
+
+void animation_set_curve(Animation *animation, AnimationCurve curve) {
+    animation->curve = curve;
+}
+
+void animation_set_delay(Animation *animation, uint32_t delay_ms) {
+    animation->delay_ms = delay_ms;
+}
+
+void animation_set_duration(Animation *animation, uint32_t duration_ms) {
+    animation->duration_ms = duration_ms;
+}
+
+void animation_set_handlers(Animation *animation, AnimationHandlers handlers, void *context) {
+    animation->handlers = handlers;
+    animation->context = context;
+}
+
+bool animation_is_scheduled(Animation *animation) {
+    return animation->is_scheduled;
+}
+
+// Like the SDK, stopping one early still runs its stopped handler.
+void animation_unschedule(Animation *animation) {
+    if(!animation->is_scheduled) return;
+    unlink_animation(animation);
+    if(animation->handlers.stopped) animation->handlers.stopped(animation, false, animation->context);
+}
+
+void animation_schedule(Animation *animation) {
+    animation_unschedule(animation);
+    animation->scheduled_at = host_ms;
+    animation->is_scheduled = true;
+    animation->is_started = false;
+    animation->next = animations;
+    animations = animation;
+}
+
+// Vibes
+
+void vibes_double_pulse(void) {}
+void vibes_long_pulse(void) {}
+void vibes_short_pulse(void) {}
+
+void vibes_enqueue_custom_pattern(VibePattern pattern) {
+    (void)pattern;
+}
+
+// App messages. The phone is always there and acks every send.
+
+AppMessageResult app_message_register_callbacks(AppMessageCallbacksNode *callbacks) {
+    message_callbacks = callbacks;
+    return APP_MSG_OK;
+}
+
+AppMessageResult app_message_out_get(DictionaryIterator **iter) {
+    if(message_in_flight) return APP_MSG_BUSY;
+    message.length = 0;
+    *iter = &message;
+    return APP_MSG_OK;
+}
+
+AppMessageResult app_message_out_send(void) {
+    if(message_in_flight) return APP_MSG_BUSY;
+    message_in_flight = true;
+    message_acked_at = host_ms + HOST_MESSAGE_MS;
+    return APP_MSG_OK;
+}
+
+AppMessageResult app_message_out_release(void) {
+    return APP_MSG_OK;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator *iter, uint32_t key, const uint8_t *data, uint16_t length) {
+    (void)key;
+    (void)data;
+    iter->length += length;
+    return DICT_OK;
+}
+
+DictionaryResult dict_write_uint8(DictionaryIterator *iter, uint32_t key, uint8_t value) {
+    (void)key;
+    (void)value;
+    iter->length += 1;
+    return DICT_OK;
+}
+
+uint32_t dict_write_end(DictionaryIterator *iter) {
+    return iter->length;
+}
+
+Tuple *dict_find(DictionaryIterator *iter, uint32_t key) {
+    (void)iter;
+    (void)key;
+    return NULL;
+}
+
+ButtonId click_recognizer_get_button_id(ClickRecognizerRef recognizer) {
+    return *(ButtonId *)recognizer;
+}
@@ -0,0 +1,84 @@
+/*
+ * Pebble Round Timer - the SDK on the host
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// What tools/host/pebble_host.c and pebble_screen.c offer a host tool on
+// top of the SDK. The whole app runs against them: windows, layers,
+// animations, app timers and app messages all work, in simulated time.
+// Nothing waits for real.
+#pragma once
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+// Simulated milliseconds since the app started.
+extern uint32_t host_ms;
+
+// Stop the event loop at this simulated time, if not 0.
+extern uint32_t host_stop_at;
+
+// Called with every message the app logs, after it's been printed.
+extern void (*host_log_hook)(const char *message);
+
+// Make app_event_loop return once the current event is done.
+void host_quit(void);
+
+// Deliver whatever is due next: an app timer, an animation starting or
+// stopping, or an app message going out. False when nothing is left.
+bool host_step(void);
+
+// Called instead of the event loop, if set, to drive the app by hand.
+extern void (*host_script)(void);
+
+// Deliver everything due in the next ms milliseconds of simulated time.
+void host_run_for(uint32_t ms);
+
+// Press a button on the window on top, as the firmware would. Back
+// with no handler of its own pops the window.
+void host_click(ButtonId button, bool long_click);
+
+// The screen (tools/host/pebble_screen.c)
+
+// What the frames drawn so far have cost. A frame is drawn after every
+// event that marked something on screen dirty; the firmware then redraws
+// the whole window on top. Drawn pixels are those written, changed ones
+// those that ended up different.
+typedef struct {
+    uint32_t frames;
+    uint32_t dirty_rects;
+    uint32_t dirty_pixels;
+    uint32_t drawn_pixels;
+    uint32_t changed_pixels;
+    uint32_t glyphs;
+} HostFrameStats;
+
+extern HostFrameStats host_frame_stats;
+
+// Off unless asked for, since drawing every frame is most of the cost of
+// a run. Frames, dirty rects and dirty pixels are counted either way.
+extern bool host_render;
+
+// Where bitmaps are loaded from, as <dir>/<resource name>.pbm.
+extern const char *host_resource_dir;
+
+void host_screen_dirty(Layer *layer);
+void host_screen_frame(void);
+void host_screen_init_text_layer(TextLayer *layer);
+bool host_screen_snapshot(const char *path);
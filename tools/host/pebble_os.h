@@ -0,0 +1,98 @@
+// Just enough of the Pebble SDK 1.x headers (the OS half) to build the
+// modules in src/ with a desktop compiler, for the host tools in tools/.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+typedef struct { int16_t x, y; } GPoint;
+typedef struct { int16_t w, h; } GSize;
+typedef struct { GPoint origin; GSize size; } GRect;
+#define GRect(x,y,w,h) ((GRect){{(x),(y)},{(w),(h)}})
+#define GPoint(x,y) ((GPoint){(x),(y)})
+#define GSize(w,h) ((GSize){(w),(h)})
+typedef enum { GColorClear=-1, GColorBlack=0, GColorWhite=1 } GColor;
+typedef enum { GTextAlignmentLeft, GTextAlignmentCenter, GTextAlignmentRight } GTextAlignment;
+typedef struct GContext GContext;
+typedef void* GFont;
+typedef struct Window Window;
+typedef struct Layer { GRect bounds, frame; bool clips, hidden; struct Layer *next_sibling, *parent, *first_child; Window *window; void (*update_proc)(struct Layer*, GContext*); } Layer;
+typedef void (*WindowHandler)(Window*);
+typedef struct { WindowHandler load, appear, disappear, unload; } WindowHandlers;
+typedef void* ClickRecognizerRef;
+typedef void (*ClickHandler)(ClickRecognizerRef, void*);
+typedef struct { struct { ClickHandler handler; uint16_t repeat_interval_ms; } click; struct { ClickHandler handler; uint16_t delay_ms; } long_click; void *context; } ClickConfig;
+typedef void (*ClickConfigProvider)(ClickConfig**, void*);
+struct Window { Layer layer; WindowHandlers window_handlers; ClickConfigProvider click_config_provider; void *click_config_context; GColor background_color; bool is_fullscreen, is_loaded; };
+typedef struct { Layer layer; const char *text; GFont font; GColor text_color, background_color; GTextAlignment text_alignment; } TextLayer;
+typedef struct { void *addr; uint16_t row_size_bytes; GRect bounds; } GBitmap;
+typedef struct { Layer layer; const GBitmap *bitmap; } BitmapLayer;
+typedef struct { BitmapLayer layer; GBitmap bmp; } BmpContainer;
+typedef struct { Layer layer; Layer content_sublayer; } ScrollLayer;
+typedef enum { AnimationCurveLinear, AnimationCurveEaseOut } AnimationCurve;
+typedef struct Animation Animation;
+typedef void (*AnimationStartedHandler)(Animation*, void*);
+typedef void (*AnimationStoppedHandler)(Animation*, bool, void*);
+typedef struct { AnimationStartedHandler started; AnimationStoppedHandler stopped; } AnimationHandlers;
+struct Animation { Animation *next; AnimationHandlers handlers; void *context; uint32_t delay_ms, duration_ms, scheduled_at; AnimationCurve curve; bool is_scheduled, is_started; void (*update)(Animation*, bool finished); };
+typedef struct { Animation animation; struct { GRect from, to; } values; Layer *subject; } PropertyAnimation;
+typedef struct { int tm_sec, tm_min, tm_hour, tm_mday, tm_mon, tm_year, tm_wday, tm_yday, tm_isdst; } PblTm;
+typedef enum { BUTTON_ID_BACK, BUTTON_ID_UP, BUTTON_ID_SELECT, BUTTON_ID_DOWN, NUM_BUTTONS } ButtonId;
+typedef struct { const uint32_t *durations; uint32_t num_segments; } VibePattern;
+typedef uint32_t ResHandle;
+typedef struct { int x; } ResBankVersion;
+extern ResBankVersion APP_RESOURCES;
+void window_init(Window*, const char*);
+void window_stack_push(Window*, bool);
+void window_set_background_color(Window*, GColor);
+void window_set_fullscreen(Window*, bool);
+void window_set_click_config_provider(Window*, ClickConfigProvider);
+void window_set_window_handlers(Window*, WindowHandlers);
+Layer *window_get_root_layer(Window*);
+Window *window_stack_get_top_window(void);
+Window *window_stack_pop(bool);
+void resource_init_current_app(ResBankVersion*);
+ResHandle resource_get_handle(uint32_t);
+GFont fonts_load_custom_font(ResHandle);
+size_t resource_size(ResHandle);
+size_t resource_load(ResHandle, uint8_t*, size_t);
+void text_layer_init(TextLayer*, GRect);
+void text_layer_set_background_color(TextLayer*, GColor);
+void text_layer_set_font(TextLayer*, GFont);
+void text_layer_set_text_color(TextLayer*, GColor);
+void text_layer_set_text(TextLayer*, const char*);
+void text_layer_set_text_alignment(TextLayer*, GTextAlignment);
+const char *text_layer_get_text(TextLayer*);
+void layer_add_child(Layer*, Layer*);
+void layer_set_frame(Layer*, GRect);
+GRect layer_get_frame(Layer*);
+void layer_set_hidden(Layer*, bool);
+bool layer_get_hidden(Layer*);
+void layer_mark_dirty(Layer*);
+Window *layer_get_window(Layer*);
+void bmp_init_container(int, BmpContainer*);
+void bmp_deinit_container(BmpContainer*);
+void graphics_context_set_stroke_color(GContext*, GColor);
+void graphics_draw_line(GContext*, GPoint, GPoint);
+void property_animation_init_layer_frame(PropertyAnimation*, Layer*, GRect*, GRect*);
+void animation_set_curve(Animation*, AnimationCurve);
+void animation_set_delay(Animation*, uint32_t);
+void animation_set_duration(Animation*, uint32_t);
+void animation_set_handlers(Animation*, AnimationHandlers, void*);
+void animation_schedule(Animation*);
+void animation_unschedule(Animation*);
+bool animation_is_scheduled(Animation*);
+void get_time(PblTm*);
+void vibes_double_pulse(void);
+void vibes_long_pulse(void);
+void vibes_short_pulse(void);
+void vibes_enqueue_custom_pattern(VibePattern);
+void scroll_layer_init(ScrollLayer*, GRect);
+void scroll_layer_set_click_config_onto_window(ScrollLayer*, Window*);
+void scroll_layer_add_child(ScrollLayer*, Layer*);
+void scroll_layer_set_content_size(ScrollLayer*, GSize);
+void scroll_layer_set_content_offset(ScrollLayer*, GPoint, bool);
+void *memcpy(void*, const void*, size_t);
+ButtonId click_recognizer_get_button_id(ClickRecognizerRef);
+void resource_load_byte_range(ResHandle, uint32_t, uint8_t*, size_t);
@@ -0,0 +1,363 @@
+/*
+ * Pebble Round Timer - a 1-bit screen for the host SDK
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// The drawing half of the host SDK: a 144x168 1-bit framebuffer that the
+// window on top is drawn into, the way the firmware does it, whenever
+// something in it was marked dirty. It keeps count of what each frame
+// cost, and writes snapshots as PBM files for tools/render_test.py.
+//
+// The app's fonts are TrueType and there's no rasterizer here, so text
+// is drawn in a 5x8 pixel font stretched to roughly the size of the
+// font asked for. Snapshots show where things are and what they say,
+// not what the watch's glyphs look like.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pebble_host.h"
+
+#define SCREEN_WIDTH 144
+#define SCREEN_HEIGHT 168
+#define STATUS_BAR_HEIGHT 16
+
+struct GContext {
+    GPoint offset;
+    GRect clip;
+    GColor stroke_color;
+};
+
+bool host_render = false;
+const char *host_resource_dir = NULL;
+HostFrameStats host_frame_stats;
+
+static uint8_t screen[SCREEN_HEIGHT][SCREEN_WIDTH];
+static uint8_t drawn[SCREEN_HEIGHT][SCREEN_WIDTH];
+static bool dirty = false;
+
+// Classic 5x8 glyphs for ' ' to '~', a column per byte, top row in bit 0.
+static const uint8_t glyphs[95][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x56,0x20,0x50}, {0x00,0x08,0x07,0x03,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x2A,0x1C,0x7F,0x1C,0x2A}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x80,0x70,0x30,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x00,0x60,0x60,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x72,0x49,0x49,0x49,0x46}, {0x21,0x41,0x49,0x4D,0x33},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x31}, {0x41,0x21,0x11,0x09,0x07},
+    {0x36,0x49,0x49,0x49,0x36}, {0x46,0x49,0x49,0x29,0x1E}, {0x00,0x00,0x14,0x00,0x00}, {0x00,0x40,0x34,0x00,0x00},
+    {0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x59,0x09,0x06},
+    {0x3E,0x41,0x5D,0x59,0x4E}, {0x7C,0x12,0x11,0x12,0x7C}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x41,0x3E}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x41,0x51,0x73},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x1C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x26,0x49,0x49,0x49,0x32},
+    {0x03,0x01,0x7F,0x01,0x03}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x59,0x49,0x4D,0x43}, {0x00,0x7F,0x41,0x41,0x41},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x41,0x7F}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x03,0x07,0x08,0x00}, {0x20,0x54,0x54,0x78,0x40}, {0x7F,0x28,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x28},
+    {0x38,0x44,0x44,0x28,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x00,0x08,0x7E,0x09,0x02}, {0x18,0xA4,0xA4,0x9C,0x78},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x40,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x78,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0xFC,0x18,0x24,0x24,0x18}, {0x18,0x24,0x24,0x18,0xFC}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x24},
+    {0x04,0x04,0x3F,0x44,0x24}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x4C,0x90,0x90,0x90,0x7C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x77,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x02,0x01,0x02,0x04,0x02},
+};
+
+typedef struct {
+    int advance;
+    int width;
+    int height;
+    int line_height;
+} FontMetrics;
+
+// Point sizes of the fonts in resources/src/resource_map.json. Anything
+// else is taken for the system font.
+static int font_size(GFont font) {
+    switch((uintptr_t)font) {
+    case RESOURCE_ID_FONT_DEJAVU_SANS_BOLD_SUBSET_30: return 30;
+    case RESOURCE_ID_FONT_DEJAVU_SANS_SUBSET_22: return 22;
+    case RESOURCE_ID_FONT_DEJAVU_SANS_SUBSET_18: return 18;
+    default: return 14;
+    }
+}
+
+// DejaVu's digits are a little over half an em wide and its caps three
+// quarters of one high, descenders included.
+static FontMetrics font_metrics(GFont font) {
+    int size = font_size(font);
+    FontMetrics metrics;
+    metrics.advance = size * 7 / 16;
+    metrics.width = metrics.advance - metrics.advance / 6;
+    metrics.height = size * 3 / 4;
+    metrics.line_height = metrics.height + size / 8;
+    return metrics;
+}
+
+static GRect intersect(GRect a, GRect b) {
+    int x0 = a.origin.x > b.origin.x ? a.origin.x : b.origin.x;
+    int y0 = a.origin.y > b.origin.y ? a.origin.y : b.origin.y;
+    int x1 = a.origin.x + a.size.w < b.origin.x + b.size.w ? a.origin.x + a.size.w : b.origin.x + b.size.w;
+    int y1 = a.origin.y + a.size.h < b.origin.y + b.size.h ? a.origin.y + a.size.h : b.origin.y + b.size.h;
+    if(x1 < x0) x1 = x0;
+    if(y1 < y0) y1 = y0;
+    return GRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+static void plot(GRect clip, int x, int y, GColor color) {
+    if(color == GColorClear) return;
+    if(x < clip.origin.x || y < clip.origin.y || x >= clip.origin.x + clip.size.w || y >= clip.origin.y + clip.size.h) return;
+    screen[y][x] = color == GColorWhite;
+    drawn[y][x] = 1;
+}
+
+static void fill(GRect rect, GRect clip, GColor color) {
+    if(color == GColorClear) return;
+    rect = intersect(rect, clip);
+    for(int y = rect.origin.y; y < rect.origin.y + rect.size.h; ++y) {
+        for(int x = rect.origin.x; x < rect.origin.x + rect.size.w; ++x) plot(clip, x, y, color);
+    }
+}
+
+static void draw_glyph(GRect clip, int left, int top, FontMetrics *metrics, char c, GColor color) {
+    if(c < ' ' || c > '~') c = '?';
+    const uint8_t *columns = glyphs[c - ' '];
+    for(int y = 0; y < metrics->height; ++y) {
+        for(int x = 0; x < metrics->width; ++x) {
+            if(columns[x * 5 / metrics->width] >> (y * 8 / metrics->height) & 1) plot(clip, left + x, top + y, color);
+        }
+    }
+    ++host_frame_stats.glyphs;
+}
+
+// Greedy word wrap, like the firmware's. Returns how many characters go
+// on the line starting at text, and sets *next to where the one after starts.
+static int wrap_line(const char *text, int fits, const char **next) {
+    int length = strcspn(text, "\n");
+    if(length > fits) {
+        int cut = fits;
+        while(cut > 0 && text[cut] != ' ') --cut;
+        length = cut ? cut : fits;
+    }
+    const char *rest = text + length;
+    while(*rest == ' ') ++rest;
+    if(*rest == '\n') ++rest;
+    *next = rest;
+    return length;
+}
+
+static void draw_text_layer(TextLayer *layer, GRect rect, GRect clip) {
+    fill(rect, clip, layer->background_color);
+    if(!layer->text) return;
+    FontMetrics metrics = font_metrics(layer->font);
+    int fits = rect.size.w / metrics.advance;
+    if(fits < 1) fits = 1;
+    int top = rect.origin.y;
+    for(const char *line = layer->text; *line && top < rect.origin.y + rect.size.h; top += metrics.line_height) {
+        const char *next;
+        int length = wrap_line(line, fits, &next);
+        int width = length * metrics.advance - (metrics.advance - metrics.width);
+        int left = rect.origin.x;
+        if(layer->text_alignment == GTextAlignmentCenter) left += (rect.size.w - width) / 2;
+        if(layer->text_alignment == GTextAlignmentRight) left += rect.size.w - width;
+        for(int i = 0; i < length; ++i) {
+            if(line[i] != ' ') draw_glyph(clip, left + i * metrics.advance, top, &metrics, line[i], layer->text_color);
+        }
+        line = next;
+    }
+}
+
+// Bitmaps are kept as PBM rows: a bit per pixel, leftmost in the top bit, 1 for black.
+static void draw_bitmap_layer(BitmapLayer *layer, GRect rect, GRect clip) {
+    const GBitmap *bitmap = layer->bitmap;
+    if(!bitmap || !bitmap->addr) return;
+    const uint8_t *rows = bitmap->addr;
+    for(int y = 0; y < bitmap->bounds.size.h; ++y) {
+        for(int x = 0; x < bitmap->bounds.size.w; ++x) {
+            bool black = rows[y * bitmap->row_size_bytes + x / 8] >> (7 - x % 8) & 1;
+            plot(clip, rect.origin.x + x, rect.origin.y + y, black ? GColorBlack : GColorWhite);
+        }
+    }
+}
+
+static void draw_text_layer_proc(Layer *layer, GContext *ctx) {
+    draw_text_layer((TextLayer *)layer, GRect(ctx->offset.x, ctx->offset.y, layer->frame.size.w, layer->frame.size.h), ctx->clip);
+}
+
+static void draw_bitmap_layer_proc(Layer *layer, GContext *ctx) {
+    draw_bitmap_layer((BitmapLayer *)layer, GRect(ctx->offset.x, ctx->offset.y, layer->frame.size.w, layer->frame.size.h), ctx->clip);
+}
+
+void host_screen_init_text_layer(TextLayer *layer) {
+    layer->layer.update_proc = draw_text_layer_proc;
+}
+
+static void draw_layer(Layer *layer, GPoint origin, GRect clip) {
+    if(layer->hidden) return;
+    GRect rect = GRect(origin.x + layer->frame.origin.x, origin.y + layer->frame.origin.y, layer->frame.size.w, layer->frame.size.h);
+    if(layer->clips) clip = intersect(clip, rect);
+    if(layer->update_proc) {
+        GContext ctx = { rect.origin, clip, GColorBlack };
+        layer->update_proc(layer, &ctx);
+    }
+    for(Layer *child = layer->first_child; child; child = child->next_sibling) {
+        draw_layer(child, GPoint(rect.origin.x + layer->bounds.origin.x, rect.origin.y + layer->bounds.origin.y), clip);
+    }
+}
+
+static int16_t window_top(Window *window) {
+    return window->is_fullscreen ? 0 : STATUS_BAR_HEIGHT;
+}
+
+// Where a layer is on screen, or an empty rect if it isn't in the window on top.
+static GRect screen_rect(Layer *layer) {
+    GRect rect = layer->frame;
+    Layer *l = layer;
+    for(; l->parent; l = l->parent) {
+        rect.origin.x += l->parent->frame.origin.x + l->parent->bounds.origin.x;
+        rect.origin.y += l->parent->frame.origin.y + l->parent->bounds.origin.y;
+    }
+    Window *window = l->window;
+    if(!window || window != window_stack_get_top_window()) return GRect(0, 0, 0, 0);
+    rect.origin.y += window_top(window);
+    return intersect(rect, GRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT));
+}
+
+void host_screen_dirty(Layer *layer) {
+    GRect rect = screen_rect(layer);
+    if(!rect.size.w || !rect.size.h) return;
+    dirty = true;
+    ++host_frame_stats.dirty_rects;
+    host_frame_stats.dirty_pixels += rect.size.w * rect.size.h;
+}
+
+// Like the firmware, redraw the whole window on top if anything in it changed.
+void host_screen_frame(void) {
+    if(!dirty) return;
+    dirty = false;
+    ++host_frame_stats.frames;
+    if(!host_render) return;
+
+    static uint8_t before[SCREEN_HEIGHT][SCREEN_WIDTH];
+    memcpy(before, screen, sizeof(screen));
+    memset(drawn, 0, sizeof(drawn));
+    GRect all = GRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    fill(GRect(0, 0, SCREEN_WIDTH, STATUS_BAR_HEIGHT), all, GColorBlack);
+    Window *window = window_stack_get_top_window();
+    if(window) {
+        GRect rect = GRect(0, window_top(window), SCREEN_WIDTH, SCREEN_HEIGHT - window_top(window));
+        fill(rect, all, window->background_color);
+        draw_layer(&window->layer, GPoint(0, window_top(window)), rect);
+    }
+    for(int y = 0; y < SCREEN_HEIGHT; ++y) {
+        for(int x = 0; x < SCREEN_WIDTH; ++x) {
+            host_frame_stats.drawn_pixels += drawn[y][x];
+            host_frame_stats.changed_pixels += screen[y][x] != before[y][x];
+        }
+    }
+}
+
+bool host_screen_snapshot(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if(!file) return false;
+    fprintf(file, "P4\n%d %d\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    for(int y = 0; y < SCREEN_HEIGHT; ++y) {
+        for(int x = 0; x < SCREEN_WIDTH; x += 8) {
+            uint8_t bits = 0;
+            for(int i = 0; i < 8; ++i) bits |= !screen[y][x + i] << (7 - i);
+            fputc(bits, file);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+// Drawing calls
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+    ctx->stroke_color = color;
+}
+
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1) {
+    int x = p0.x, y = p0.y;
+    int dx = abs(p1.x - p0.x), dy = -abs(p1.y - p0.y);
+    int sx = p0.x < p1.x ? 1 : -1, sy = p0.y < p1.y ? 1 : -1;
+    int error = dx + dy;
+    for(;;) {
+        plot(ctx->clip, ctx->offset.x + x, ctx->offset.y + y, ctx->stroke_color);
+        if(x == p1.x && y == p1.y) break;
+        int twice = 2 * error;
+        if(twice >= dy) {
+            error += dy;
+            x += sx;
+        }
+        if(twice <= dx) {
+            error += dx;
+            y += sy;
+        }
+    }
+}
+
+// Bitmaps come from <host_resource_dir>/<name>.pbm, which tools/render_test.py
+// converts from the app's PNGs. Without them bitmap layers stay empty.
+static const char *bitmap_name(int resource_id) {
+    switch(resource_id) {
+    case RESOURCE_ID_IMAGE_MENU_ICON: return "IMAGE_MENU_ICON";
+    case RESOURCE_ID_IMAGE_BUTTON_LABELS: return "IMAGE_BUTTON_LABELS";
+    default: return NULL;
+    }
+}
+
+static bool load_pbm(const char *path, GBitmap *bitmap) {
+    FILE *file = fopen(path, "rb");
+    if(!file) return false;
+    int width, height;
+    bool loaded = false;
+    if(fscanf(file, "P4 %d %d", &width, &height) == 2 && fgetc(file) != EOF) {
+        bitmap->row_size_bytes = (width + 7) / 8;
+        bitmap->bounds = GRect(0, 0, width, height);
+        bitmap->addr = malloc(bitmap->row_size_bytes * height);
+        loaded = fread(bitmap->addr, bitmap->row_size_bytes, height, file) == (size_t)height;
+        if(!loaded) {
+            free(bitmap->addr);
+            bitmap->addr = NULL;
+        }
+    }
+    fclose(file);
+    return loaded;
+}
+
+void bmp_init_container(int resource_id, BmpContainer *container) {
+    memset(container, 0, sizeof(*container));
+    container->layer.layer.clips = true;
+    container->layer.layer.update_proc = draw_bitmap_layer_proc;
+    container->layer.bitmap = &container->bmp;
+    const char *name = bitmap_name(resource_id);
+    if(host_resource_dir && name) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s.pbm", host_resource_dir, name);
+        load_pbm(path, &container->bmp);
+    }
+    layer_set_frame(&container->layer.layer, container->bmp.bounds);
+}
+
+void bmp_deinit_container(BmpContainer *container) {
+    free(container->bmp.addr);
+    container->bmp.addr = NULL;
+}
@@ -0,0 +1,107 @@
+/*
+ * Pebble Round Timer - screen snapshots on the host
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Runs the app on tools/host/pebble_host.c with the screen drawn, presses
+// its buttons through a short session and snapshots the screen along the
+// way. Build and run it through tools/render_test.py, which turns the
+// snapshots into PNGs and compares them with the golden ones.
+//
+// Each snapshot is logged with what the frames since the last one cost.
+
+#include <stdio.h>
+#include <getopt.h>
+
+#include "pebble_host.h"
+#include "common.h"
+
+void pbl_main(void *params);
+
+static const char *output_dir = ".";
+static bool failed = false;
+
+static void snapshot(const char *name) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.pbm", output_dir, name);
+    if(!host_screen_snapshot(path)) {
+        fprintf(stderr, "couldn't write %s\n", path);
+        failed = true;
+    }
+    HostFrameStats *s = &host_frame_stats;
+    printf("{\"snapshot\":\"%s\",\"frames\":%lu,\"dirty_rects\":%lu,\"dirty_pixels\":%lu,"
+        "\"drawn_pixels\":%lu,\"changed_pixels\":%lu,\"glyphs\":%lu}\n", name,
+        (unsigned long)s->frames, (unsigned long)s->dirty_rects, (unsigned long)s->dirty_pixels,
+        (unsigned long)s->drawn_pixels, (unsigned long)s->changed_pixels, (unsigned long)s->glyphs);
+    memset(s, 0, sizeof(*s));
+}
+
+static void press(ButtonId button, int times) {
+    for(int i = 0; i < times; ++i) {
+        host_click(button, false);
+        host_run_for(200);
+    }
+}
+
+// The defaults: 10 rounds of a minute with 15 s rests, no warning.
+static void script(void) {
+    host_run_for(1000);
+    snapshot("config");
+
+    host_click(BUTTON_ID_SELECT, true);
+    host_run_for(1000);
+    snapshot("ready");
+
+    // Start, and look in on the first round, its rest and a pause.
+    press(BUTTON_ID_SELECT, 1);
+    host_run_for(30000);
+    snapshot("round");
+    host_run_for(35000);
+    snapshot("rest");
+    press(BUTTON_ID_SELECT, 1);
+    host_run_for(4000);
+    snapshot("paused");
+
+    // Reset, which files the session, then read it back from the config menu.
+    press(BUTTON_ID_UP, 1);
+    press(BUTTON_ID_BACK, 1);
+    press(BUTTON_ID_SELECT, 8);
+    snapshot("config_history");
+    press(BUTTON_ID_UP, 1);
+    host_run_for(1000);
+    snapshot("history");
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while((opt = getopt(argc, argv, "o:r:")) != -1) {
+        switch(opt) {
+        case 'o': output_dir = optarg; break;
+        case 'r': host_resource_dir = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-o snapshot dir] [-r resource dir]\n", argv[0]);
+            return 2;
+        }
+    }
+    host_render = true;
+    host_script = script;
+    pbl_main(NULL);
+    return failed ? 1 : 0;
+}
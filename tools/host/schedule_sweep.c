@@ -0,0 +1,347 @@
+/*
+ * Pebble Round Timer - schedule arithmetic sweep on the host
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Checks the schedule arithmetic in src/round_timer.c against the loops
+// it replaced, for every round, warning, rest and count setting the
+// config screen can produce. Build and run it through
+// tools/schedule_sweep.py, which shards it across every core.
+//
+// The config screen moves each time in steps of 1 s or 1 min, between 0
+// and 99:00.059, clamping at both ends. That leaves every k s and every
+// k s + 59 ms up to the top: 11882 values per setting. Every triple would
+// be 1.7e12 configs, but the arithmetic splits cleanly, so the passes
+// cover it between them:
+//
+//   rounds  every round x rest: two ticks either side of every period
+//           change in the first two rounds, and of the end of each of
+//           the first 99 rounds, i.e. wherever a round count can finish.
+//           Nothing before the round time depends on the rest time, and
+//           nothing after it on the warning (below the round time the
+//           period only compares against round - warning, and the next
+//           boundary is never the end of the full round).
+//   warning every round x warning, over the first round, which is all
+//           the warning can touch.
+//   every   every millisecond of the first three rounds of every config
+//           up to 5.059 s, next boundary included.
+//   sample  random triples, every check at once, to back up the split.
+//
+// time_to_next_boundary() has no loop to compare against. What matters
+// is that it's never late: the period may not change before it says. A
+// boundary that turns out not to change anything is only a spare wakeup,
+// so those are counted rather than failed; a round time of 0 has them.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "common.h"
+#include "timers.h"
+#include "clock.h"
+#include "session.h"
+#include "round_timer.h"
+#include "program.h"
+
+#define MAX_TIME (99 * 60000 + 59)
+#define VALUE_COUNT (2 * (MAX_TIME / 1000 + 1))
+#define SAMPLE_COUNT 20000000
+#define EVERY_LIMIT 10059
+
+time_t round_time;
+time_t warning_time;
+time_t rest_time;
+int total_round_count;
+
+// What round_timer.c needs from the rest of the app, none of which the
+// arithmetic touches.
+time_t clock_now() { return 0; }
+time_t clock_between() { return 0; }
+time_t clock_sync(time_t *since, bool *moved) { *moved = false; return 0; }
+void timer_init(Timer *timer, TimerCallback callback, void *data) {}
+void timer_schedule(Timer *timer, uint32_t delay) {}
+void timer_cancel(Timer *timer) {}
+bool timer_is_pending(Timer *timer) { return false; }
+void session_begin(SessionRecord *session) {}
+void session_round(SessionRecord *session, int rounds_done, time_t elapsed) {}
+void session_finish(SessionRecord *session, time_t elapsed, time_t paused) {}
+bool program_loaded() { return false; }
+int program_rounds() { return 0; }
+ProgramSegment *program_find(time_t elapsed) { return NULL; }
+void app_log(uint8_t level, const char *file, int line, const char *fmt, ...) {}
+
+// The originals, as they were in stopwatch.c. With no round or rest time
+// at all they never finished; the replacement deliberately returns the
+// elapsed time unchanged and 0 rounds instead, and that's what's expected.
+static time_t reference_running_time(time_t elapsed) {
+    time_t running_time = elapsed;
+    time_t full_round = round_time + rest_time;
+    if (full_round <= 0) return elapsed;
+    for (; running_time > full_round; running_time -= full_round);
+
+    return running_time;
+}
+
+static int reference_round_count(time_t elapsed) {
+    time_t running_time = elapsed;
+    time_t full_round = round_time + rest_time;
+    int round_counter = 0;
+    if (full_round <= 0) return 0;
+    for (; running_time > full_round; running_time -= full_round) round_counter++;
+
+    return round_counter;
+}
+
+static int period_for(time_t running_time) {
+    if (running_time < round_time) {
+        if (warning_time != 0 && running_time > round_time - warning_time) {
+            return 1;
+        }
+        return 0;
+    }
+    return 2;
+}
+
+static time_t counter_for(time_t running_time) {
+    if (running_time < round_time) {
+        return round_time - running_time;
+    }
+    running_time -= round_time;
+    return rest_time - running_time;
+}
+
+static int reference_period(time_t elapsed) {
+    return period_for(reference_running_time(elapsed));
+}
+
+static time_t values[VALUE_COUNT];
+static long checks = 0;
+static long failures = 0;
+static long spare_wakeups = 0;
+
+static void fail(const char *what, time_t elapsed, long got, long expected) {
+    if (++failures <= 10) {
+        printf("FAIL %s: round %ld warning %ld rest %ld elapsed %ld: got %ld, expected %ld\n", what,
+            (long)round_time, (long)warning_time, (long)rest_time, (long)elapsed, got, expected);
+    }
+}
+
+#define CHECK(what, elapsed, got, expected) do { \
+        long got_ = (got), expected_ = (expected); \
+        ++checks; \
+        if (got_ != expected_) fail(what, elapsed, got_, expected_); \
+    } while (0)
+
+// Everything that can be checked at one elapsed time, given what the
+// loops make of it.
+static void check_at(time_t elapsed, time_t running_time, int rounds) {
+    CHECK("running_time", elapsed, single_round_running_time(elapsed), running_time);
+    CHECK("round_count", elapsed, current_round_count(elapsed), rounds);
+    CHECK("period", elapsed, get_round_period(elapsed), period_for(running_time));
+    CHECK("counter", elapsed, current_counter(elapsed), counter_for(running_time));
+}
+
+static void check_reference_at(time_t elapsed) {
+    if (elapsed < 0) return;
+    check_at(elapsed, reference_running_time(elapsed), reference_round_count(elapsed));
+}
+
+// The next boundary may be early but never late.
+static void check_boundary_at(time_t elapsed) {
+    if (elapsed < 0) return;
+    time_t delay = time_to_next_boundary(elapsed);
+    int period = reference_period(elapsed);
+    ++checks;
+    if (delay < 0) {
+        fail("next_boundary negative", elapsed, delay, 0);
+    } else if (delay == 0) {
+        // Claims nothing ever changes again; look a couple of rounds on.
+        time_t full_round = round_time + rest_time;
+        time_t points[] = { round_time - warning_time + 1, round_time, full_round + 1 };
+        for (unsigned int i = 0; i < sizeof(points) / sizeof(points[0]); ++i) {
+            time_t at = elapsed - single_round_running_time(elapsed) + points[i];
+            if (at > elapsed && reference_period(at) != period) fail("next_boundary never", elapsed, 0, at - elapsed);
+        }
+    } else {
+        if (delay > 1 && reference_period(elapsed + delay - 1) != period) {
+            fail("next_boundary late", elapsed, delay, -1);
+        }
+        if (reference_period(elapsed + delay) == period) ++spare_wakeups;
+    }
+}
+
+// The points either side of every period change in the first two rounds.
+static void check_first_rounds() {
+    time_t full_round = round_time + rest_time;
+    time_t warning_start = round_time - warning_time + 1;
+    time_t marks[] = { 0, warning_start, round_time, full_round, full_round + warning_start, full_round + round_time,
+                       2 * full_round };
+    for (unsigned int i = 0; i < sizeof(marks) / sizeof(marks[0]); ++i) {
+        for (time_t d = -2; d <= 2; ++d) {
+            check_reference_at(marks[i] + d);
+            check_boundary_at(marks[i] + d);
+        }
+    }
+}
+
+static void pass_rounds(int shard, int shards) {
+    warning_time = 0;
+    for (int i = shard; i < VALUE_COUNT; i += shards) {
+        round_time = values[i];
+        for (int j = 0; j < VALUE_COUNT; ++j) {
+            rest_time = values[j];
+            time_t full_round = round_time + rest_time;
+            if (full_round == 0) {
+                // The loops would never finish here; see above.
+                for (time_t elapsed = 0; elapsed < 3; ++elapsed) check_at(elapsed, elapsed, 0);
+                continue;
+            }
+            check_first_rounds();
+            // From the second round on the loops just peel off whole rounds,
+            // so the end of round k looks like the end of the first, k - 1
+            // rounds later. That's every count the config screen can set.
+            for (int k = 2; k <= 99; ++k) {
+                for (time_t d = -2; d <= 2; ++d) {
+                    time_t running_time = reference_running_time(full_round + d);
+                    int rounds = reference_round_count(full_round + d) + k - 1;
+                    check_at(k * full_round + d, running_time, rounds);
+                }
+            }
+        }
+    }
+}
+
+static void pass_warning(int shard, int shards) {
+    rest_time = 0;
+    for (int i = shard; i < VALUE_COUNT; i += shards) {
+        round_time = values[i];
+        for (int j = 0; j < VALUE_COUNT; ++j) {
+            warning_time = values[j];
+            time_t warning_start = round_time - warning_time + 1;
+            time_t marks[] = { 0, warning_start, round_time };
+            for (unsigned int m = 0; m < sizeof(marks) / sizeof(marks[0]); ++m) {
+                for (time_t d = -2; d <= 2; ++d) {
+                    time_t elapsed = marks[m] + d;
+                    if (elapsed < 0 || elapsed > round_time) continue;
+                    check_reference_at(elapsed);
+                    check_boundary_at(elapsed);
+                }
+            }
+        }
+    }
+}
+
+// Every millisecond, with the next boundary checked against the next
+// change found by looking.
+static void pass_every(int shard, int shards) {
+    static int periods[3 * 2 * EVERY_LIMIT + 4];
+    static time_t next_change[3 * 2 * EVERY_LIMIT + 4];
+    int small = 0;
+    while (values[small] <= EVERY_LIMIT) ++small;
+    int config = 0;
+    for (int a = 0; a < small; ++a) for (int b = 0; b < small; ++b) for (int c = 0; c < small; ++c) {
+        if (config++ % shards != shard) continue;
+        round_time = values[a];
+        warning_time = values[b];
+        rest_time = values[c];
+        time_t full_round = round_time + rest_time;
+        if (full_round == 0) continue; // covered by pass_rounds
+        time_t end = 3 * full_round + 2;
+        for (time_t elapsed = 0; elapsed <= end; ++elapsed) {
+            check_reference_at(elapsed);
+            periods[elapsed] = reference_period(elapsed);
+        }
+        next_change[end] = 0;
+        for (time_t elapsed = end - 1; elapsed >= 0; --elapsed) {
+            if (periods[elapsed + 1] != periods[elapsed]) next_change[elapsed] = 1;
+            else next_change[elapsed] = next_change[elapsed + 1] ? next_change[elapsed + 1] + 1 : 0;
+        }
+        for (time_t elapsed = 0; elapsed <= 2 * full_round + 1; ++elapsed) {
+            time_t delay = time_to_next_boundary(elapsed);
+            ++checks;
+            if (next_change[elapsed] && (delay == 0 || delay > next_change[elapsed])) {
+                fail("next_boundary late", elapsed, delay, next_change[elapsed]);
+            } else if (delay && delay != next_change[elapsed]) {
+                ++spare_wakeups;
+            }
+        }
+    }
+}
+
+static uint32_t seed = 88172645;
+static uint32_t random_below(uint32_t n) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed % n;
+}
+
+static void pass_sample(int shard, int shards) {
+    seed += shard * 7919;
+    for (int i = shard; i < SAMPLE_COUNT; i += shards) {
+        round_time = values[random_below(VALUE_COUNT)];
+        warning_time = values[random_below(VALUE_COUNT)];
+        rest_time = values[random_below(VALUE_COUNT)];
+        if (round_time + rest_time == 0) continue;
+        check_first_rounds();
+        time_t elapsed = random_below(100) * (round_time + rest_time) + random_below(round_time + rest_time + 1);
+        check_reference_at(elapsed);
+        check_boundary_at(elapsed);
+    }
+}
+
+int main(int argc, char **argv) {
+    int shard = 0, shards = 1;
+    const char *passes = "rounds,warning,every,sample";
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:p:")) != -1) {
+        switch (opt) {
+            case 's': shard = atoi(optarg); break;
+            case 'n': shards = atoi(optarg); break;
+            case 'p': passes = optarg; break;
+            default:
+                fprintf(stderr, "usage: %s [-s shard] [-n shards] [-p rounds,warning,every,sample]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    for (int k = 0; k < VALUE_COUNT / 2; ++k) {
+        values[2 * k] = k * 1000;
+        values[2 * k + 1] = k * 1000 + 59;
+    }
+
+    struct { const char *name; void (*run)(int, int); } all[] = {
+        { "rounds", pass_rounds }, { "warning", pass_warning }, { "every", pass_every }, { "sample", pass_sample }
+    };
+    for (unsigned int i = 0; i < sizeof(all) / sizeof(all[0]); ++i) {
+        if (!strstr(passes, all[i].name)) continue;
+        long before = checks;
+        clock_t began = clock();
+        all[i].run(shard, shards);
+        printf("%s %ld checks %.1f s\n", all[i].name, checks - before, (double)(clock() - began) / CLOCKS_PER_SEC);
+        fflush(stdout);
+    }
+    printf("total %ld checks %ld failures %ld spare_wakeups\n", checks, failures, spare_wakeups);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * Pebble Round Timer - pause and resume timing test on the host
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Runs src/clock.c, src/timers.c and src/round_timer.c against a stand-in
+// for the app timer service and a pebble clock that ticks over on real
+// (simulated) second edges, and checks what a round timer reports against
+// what really happened. Build and run it through tools/timing_test.py.
+//
+// The tick is the app's: sync the clock, then re-arm on the phase of the
+// second. Button presses land between app timer events, as they do on
+// the watch. A timer is run and paused over and over, and at the end its
+// elapsed and paused times, and their sum, are compared with the truth;
+// each has to be within -e ms. Nothing says when between two wakeups a
+// press came, so every start and stop is off by up to half a tick either
+// way. That should average out: what piles up over hundreds of stops is
+// a bias. -b keeps a second timer running throughout, so the clock never
+// stops ticking and the resume path isn't taken.
+//
+// First, though, the clock ticks along for a minute on its own. Ticks
+// that land where they were aimed should never have it corrected, so
+// with no jitter a single correction there fails the run.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "common.h"
+#include "timers.h"
+#include "clock.h"
+#include "session.h"
+#include "round_timer.h"
+#include "program.h"
+
+#define MAX_EVENTS 16
+#define TICK 100
+
+typedef struct {
+    AppTimerHandle handle;
+    uint32_t due;
+    uint32_t cookie;
+} Event;
+
+static Event events[MAX_EVENTS];
+static int event_count = 0;
+static AppTimerHandle next_handle = 1;
+static uint32_t real_ms = 0;
+static uint32_t jitter = 0;
+// The pebble clock, a while after 2012 and part way through a second.
+static time_t epoch_seconds = 400000000;
+static uint32_t epoch_phase = 0;
+
+static uint32_t seed = 2463534242u;
+static uint32_t random_below(uint32_t n) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed % n;
+}
+
+AppTimerHandle app_timer_send_event(AppContextRef ctx, uint32_t delay, uint32_t cookie) {
+    if(event_count == MAX_EVENTS) {
+        fprintf(stderr, "too many app timers pending\n");
+        exit(2);
+    }
+    events[event_count].due = real_ms + delay + (jitter ? random_below(jitter + 1) : 0);
+    events[event_count].cookie = cookie;
+    events[event_count].handle = next_handle;
+    ++event_count;
+    return next_handle++;
+}
+
+bool app_timer_cancel_event(AppContextRef ctx, AppTimerHandle handle) {
+    for(int i = 0; i < event_count; ++i) {
+        if(events[i].handle != handle) continue;
+        events[i] = events[--event_count];
+        return true;
+    }
+    return false;
+}
+
+static time_t simulated_seconds() {
+    return epoch_seconds + (epoch_phase + real_ms) / 1000;
+}
+
+// What the rest of the app would do, none of which touches the timing.
+void get_time(PblTm *t) { memset(t, 0, sizeof(*t)); }
+void session_begin(SessionRecord *session) {}
+void session_round(SessionRecord *session, int rounds_done, time_t elapsed) {}
+void session_finish(SessionRecord *session, time_t elapsed, time_t paused) {}
+bool program_loaded() { return false; }
+int program_rounds() { return 0; }
+ProgramSegment *program_find(time_t elapsed) { return NULL; }
+void app_log(uint8_t level, const char *file, int line, const char *fmt, ...) {}
+static void boundary(RoundTimer *timer) {}
+
+// Delivers every app timer event due up to until, in order.
+static void run_to(uint32_t until) {
+    for(;;) {
+        int next = -1;
+        for(int i = 0; i < event_count; ++i) {
+            if((int32_t)(events[i].due - until) > 0) continue;
+            if(next < 0 || (int32_t)(events[i].due - events[next].due) < 0) next = i;
+        }
+        if(next < 0) break;
+        Event event = events[next];
+        events[next] = events[--event_count];
+        real_ms = event.due;
+        timers_handle_event(NULL, event.handle, event.cookie);
+    }
+    real_ms = until;
+}
+
+// The app's tick, counting how often the clock had to be put right.
+static Timer update_timer;
+static uint32_t corrections = 0;
+static uint32_t ticks = 0;
+static void handle_tick(void *data) {
+    time_t before = clock_now();
+    round_timers_sync();
+    if(clock_now() != before) ++corrections;
+    ++ticks;
+    timer_schedule(&update_timer, clock_phase_delay(TICK));
+}
+
+// stop_stopwatch() and start_stopwatch(), for one timer.
+static void start(RoundTimer *timer) {
+    if(!round_timers_running()) {
+        clock_resume();
+        timer_schedule(&update_timer, TICK);
+    }
+    round_timer_start(timer);
+}
+
+static void stop(RoundTimer *timer) {
+    round_timer_stop(timer);
+    if(!round_timers_running()) timer_cancel(&update_timer);
+}
+
+int main(int argc, char **argv) {
+    int cycles = 500;
+    bool background = false;
+    uint32_t allowed = 0;
+    int opt;
+    while((opt = getopt(argc, argv, "c:j:e:s:b")) != -1) {
+        switch(opt) {
+            case 'c': cycles = atoi(optarg); break;
+            case 'j': jitter = atoi(optarg); break;
+            case 'e': allowed = atoi(optarg); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            case 'b': background = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-c cycles] [-j jitter_ms] [-e allowed_ms] [-s seed] [-b]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    epoch_phase = random_below(1000);
+    set_pebble_seconds_source(simulated_seconds);
+    timers_init(NULL);
+    timer_init(&update_timer, handle_tick, NULL);
+    round_timers_init(boundary);
+
+    // Let the clock find its first edge, as it would while the config
+    // window is up, so we start from a clock that's already anchored.
+    // Then see that it's left alone while it keeps time.
+    RoundTimer *timer = &round_timers[0];
+    start(&round_timers[1]);
+    run_to(real_ms + 2000);
+    uint32_t steady_from = corrections;
+    run_to(real_ms + 60000);
+    uint32_t steady = corrections - steady_from;
+    if(!background) {
+        stop(&round_timers[1]);
+        round_timer_reset(&round_timers[1]);
+    }
+    run_to(real_ms + 1000 + random_below(1000));
+    corrections = 0;
+    ticks = 0;
+
+    time_t true_elapsed = 0, true_paused = 0;
+    uint32_t first_start = real_ms;
+    time_t worst = 0;
+    for(int i = 0; i < cycles; ++i) {
+        start(timer);
+        uint32_t run = 300 + random_below(7000);
+        run_to(real_ms + run);
+        true_elapsed += run;
+        stop(timer);
+        time_t off = timer->elapsed - true_elapsed;
+        if(off < 0) off = -off;
+        if(off > worst) worst = off;
+        if(i == cycles - 1) break;
+        uint32_t pause = 100 + random_below(5000);
+        run_to(real_ms + pause);
+        true_paused += pause;
+    }
+    time_t wall = real_ms - first_start;
+
+    printf("%d runs, %ld ms running, %ld ms paused, %u ticks, %u clock corrections\n", cycles,
+        (long)true_elapsed, (long)true_paused, ticks, corrections);
+    printf("elapsed %+ld ms, paused %+ld ms, together %+ld ms off the wall clock\n",
+        (long)(timer->elapsed - true_elapsed), (long)(timer->paused - true_paused),
+        (long)(timer->elapsed + timer->paused - wall));
+    printf("elapsed was at most %ld ms off at a stop\n", (long)worst);
+    printf("%u clock corrections in a minute of steady ticking\n", steady);
+    if(!jitter && steady) return 1;
+
+    time_t off[] = { timer->elapsed - true_elapsed, timer->paused - true_paused, timer->elapsed + timer->paused - wall };
+    for(unsigned int i = 0; allowed && i < sizeof(off) / sizeof(off[0]); ++i) {
+        if(off[i] > (time_t)allowed || -off[i] > (time_t)allowed) return 1;
+    }
+    return 0;
+}
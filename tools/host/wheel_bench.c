@@ -0,0 +1,226 @@
+/*
+ * Pebble Round Timer - timer wheel benchmark on the host
+ * Copyright (C) 2013 Jason Chu
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Runs src/timers.c against a stand-in for the app timer service, with
+// thousands of timers pending at once. Build and run it through
+// tools/wheel_bench.py.
+//
+// Every timer reschedules itself when it fires, and records how late it
+// was against the simulated real time. "Clicks" arrive between app timer
+// events and schedule a short timer, the way the deferred queue does,
+// which makes the wheel drop the app timer it was waiting on. A 1 s tick
+// stands in for the clock's resync and credits the wheel with whatever
+// real time it missed; -n turns that off to show what it costs.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#include "timers.h"
+
+#define MAX_EVENTS 64
+#define CLICK 0xC11C
+#define DRAIN_DELAY 33
+
+typedef struct {
+    AppTimerHandle handle;
+    uint32_t due;
+    uint32_t cookie;
+} Event;
+
+static Event events[MAX_EVENTS];
+static int event_count = 0;
+static AppTimerHandle next_handle = 1;
+static uint32_t real_ms = 0;
+static uint32_t jitter = 0;
+static uint32_t wakeups = 0;
+
+static uint32_t seed = 2463534242u;
+static uint32_t random_below(uint32_t n) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed % n;
+}
+
+AppTimerHandle app_timer_send_event(AppContextRef ctx, uint32_t delay, uint32_t cookie) {
+    if(event_count == MAX_EVENTS) {
+        fprintf(stderr, "too many app timers pending\n");
+        exit(2);
+    }
+    // The real service is never early, and often a little late.
+    events[event_count].due = real_ms + delay + (jitter ? random_below(jitter + 1) : 0);
+    events[event_count].cookie = cookie;
+    events[event_count].handle = next_handle;
+    ++event_count;
+    return next_handle++;
+}
+
+bool app_timer_cancel_event(AppContextRef ctx, AppTimerHandle handle) {
+    for(int i = 0; i < event_count; ++i) {
+        if(events[i].handle != handle) continue;
+        events[i] = events[--event_count];
+        return true;
+    }
+    return false;
+}
+
+void app_log(uint8_t level, const char *file, int line, const char *fmt, ...) {
+}
+
+static double seconds_now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// The timers under test.
+typedef struct {
+    Timer timer;
+    uint32_t period;
+    uint32_t due;
+} Load;
+
+static Load *loads;
+static int load_count = 10000;
+static uint32_t longest = 20 * 60 * 1000;
+static uint32_t fired = 0;
+static uint32_t max_late = 0;
+static uint32_t early = 0;
+static uint64_t total_late = 0;
+
+// Like the app's own timers, each one aims at a fixed time rather than
+// a delay from whenever it ran, so lateness doesn't pile up.
+static void load_fired(void *data) {
+    Load *load = data;
+    int32_t late = real_ms - load->due;
+    if(late < 0) ++early;
+    else if((uint32_t)late > max_late) max_late = late;
+    if(late > 0) total_late += late;
+    ++fired;
+    load->due += load->period;
+    int32_t delay = load->due - timers_now();
+    timer_schedule(&load->timer, delay > 0 ? delay : 0);
+}
+
+static Timer drain;
+static void drain_fired(void *data) {
+}
+
+static Timer resync;
+static bool resyncing = true;
+static void resync_fired(void *data) {
+    uint32_t now = timers_now();
+    if((int32_t)(real_ms - now) > 0) timers_credit(real_ms - now);
+    timer_schedule(&resync, 1000);
+}
+
+// Raw schedule and cancel costs with everything else already pending.
+static void time_operations() {
+    Timer *extra = malloc(sizeof(Timer) * load_count);
+    for(int i = 0; i < load_count; ++i) timer_init(&extra[i], drain_fired, NULL);
+
+    double began = seconds_now();
+    for(int i = 0; i < load_count; ++i) timer_schedule(&extra[i], 1 + random_below(longest));
+    double scheduled = seconds_now();
+    for(int i = 0; i < load_count; ++i) timer_cancel(&extra[i]);
+    double cancelled = seconds_now();
+
+    printf("schedule: %.0f ns each with %d pending\n", (scheduled - began) / load_count * 1e9, 2 * load_count);
+    printf("cancel: %.0f ns each\n", (cancelled - scheduled) / load_count * 1e9);
+    free(extra);
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration = 3600 * 1000;
+    uint32_t click_every = 2000;
+    uint32_t allowed_late = 0;
+    int opt;
+    while((opt = getopt(argc, argv, "t:d:c:j:l:m:n")) != -1) {
+        switch(opt) {
+            case 't': load_count = atoi(optarg); break;
+            case 'd': duration = atoi(optarg) * 1000u; break;
+            case 'c': click_every = atoi(optarg); break;
+            case 'j': jitter = atoi(optarg); break;
+            case 'l': longest = atoi(optarg); break;
+            case 'm': allowed_late = atoi(optarg); break;
+            case 'n': resyncing = false; break;
+            default:
+                fprintf(stderr, "usage: %s [-t timers] [-d seconds] [-c click_ms] [-j jitter_ms] [-l longest_ms] [-m max_late_ms] [-n]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    timers_init(NULL);
+    timer_init(&drain, drain_fired, NULL);
+    timer_init(&resync, resync_fired, NULL);
+    if(resyncing) timer_schedule(&resync, 1000);
+
+    loads = malloc(sizeof(Load) * load_count);
+    for(int i = 0; i < load_count; ++i) {
+        timer_init(&loads[i].timer, load_fired, &loads[i]);
+        loads[i].period = 100 + random_below(longest - 100);
+        loads[i].due = loads[i].period;
+        timer_schedule(&loads[i].timer, loads[i].period);
+    }
+    time_operations();
+
+    // Clicks are app events of their own, so they land between wakeups.
+    if(click_every) app_timer_send_event(NULL, 1 + random_below(2 * click_every), CLICK);
+
+    double began = seconds_now();
+    while(real_ms < duration && event_count) {
+        int next = 0;
+        for(int i = 1; i < event_count; ++i) {
+            if((int32_t)(events[i].due - events[next].due) < 0) next = i;
+        }
+        Event event = events[next];
+        events[next] = events[--event_count];
+        real_ms = event.due;
+        if(event.cookie == CLICK) {
+            timer_schedule(&drain, DRAIN_DELAY);
+            app_timer_send_event(NULL, 1 + random_below(2 * click_every), CLICK);
+        } else {
+            ++wakeups;
+            timers_handle_event(NULL, event.handle, event.cookie);
+        }
+    }
+    double took = seconds_now() - began;
+
+    printf("ran %u s with %d timers pending: %u fired, %u wakeups\n", duration / 1000, load_count, fired, wakeups);
+    printf("dispatch: %.0f ns per timer fired, %.0f ns per wakeup\n", took / (fired ? fired : 1) * 1e9,
+        took / (wakeups ? wakeups : 1) * 1e9);
+    printf("late: %u ms at most, %.1f ms on average%s\n", max_late, fired ? (double)total_late / fired : 0.0,
+        resyncing ? "" : " (no resync)");
+    if(early) {
+        printf("%u fired early\n", early);
+        return 1;
+    }
+    if(allowed_late && max_late > allowed_late) {
+        printf("late by more than %u ms\n", allowed_late);
+        return 1;
+    }
+    return 0;
+}
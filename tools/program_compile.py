@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+"""Compile an interval program into the segment table the watch loads.
+
+  program_compile.py "warmup 5m; 8x(20s work, 10s rest); cooldown 3m"
+  program_compile.py --clear                 no program: back to the config screen's settings
+  program_compile.py --fuzz 100000           throw random programs and junk at the compiler
+  program_compile.py --bench                 programs compiled per second
+
+Writes resources/src/data/program.bin (see src/program.h for the layout).
+
+The notation is a list of steps separated by ';' or ','. A step is a kind
+and a duration in either order: "work 20s", "45s rest". Kinds are work
+(or round), rest, warmup and cooldown. Durations are any of 1h, 5m, 20s,
+1m30s or 1:30. "Nx(...)" repeats the steps inside N times and nests.
+Consecutive steps of the same kind other than work are merged.
+"""
+
+import argparse
+import os
+import random
+import re
+import struct
+import sys
+import time
+
+OUTPUT = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))),
+                      "resources", "src", "data", "program.bin")
+
+VERSION = 1
+MAX_SEGMENTS = 64
+MAX_ROUNDS = 255
+HEADER = struct.Struct("<2sBBB3x")
+SEGMENT = struct.Struct("<IBB2x")
+
+WORK, REST, WARMUP, COOLDOWN = 0, 2, 3, 4
+KINDS = {"work": WORK, "round": WORK, "rest": REST, "warmup": WARMUP, "cooldown": COOLDOWN}
+NAMES = {WORK: "work", REST: "rest", WARMUP: "warmup", COOLDOWN: "cooldown"}
+
+TOKEN = re.compile(r"\s*(?:(?P<repeat>\d+)\s*x\s*\(|(?P<close>\))|(?P<sep>[;,])|"
+                   r"(?P<clock>\d+:\d{1,2})|(?P<units>(?:\d+\s*[hms]\s*)+)|(?P<word>[a-z]+))", re.I)
+UNIT = re.compile(r"(\d+)\s*([hms])", re.I)
+UNIT_MS = {"h": 3600000, "m": 60000, "s": 1000}
+
+
+class ProgramError(ValueError):
+    pass
+
+
+def tokens(text):
+    position = 0
+    text = text.strip()
+    while position < len(text):
+        match = TOKEN.match(text, position)
+        if not match or match.end() == position:
+            raise ProgramError("can't read %r" % text[position:position + 10])
+        position = match.end()
+        kind = match.lastgroup
+        if kind == "repeat":
+            yield "repeat", int(match.group("repeat"))
+        elif kind == "clock":
+            minutes, seconds = match.group("clock").split(":")
+            if int(seconds) > 59:
+                raise ProgramError("%s isn't a time" % match.group("clock"))
+            yield "duration", (int(minutes) * 60 + int(seconds)) * 1000
+        elif kind == "units":
+            yield "duration", sum(int(n) * UNIT_MS[u.lower()] for n, u in UNIT.findall(match.group("units")))
+        elif kind == "word":
+            word = match.group("word").lower()
+            if word not in KINDS:
+                raise ProgramError("unknown step %r" % word)
+            yield "kind", KINDS[word]
+        else:
+            yield kind, None
+
+
+def parse(text):
+    """[(kind, ms)] with repeats expanded."""
+    stream = list(tokens(text))
+    steps, index = parse_list(stream, 0, 0)
+    if index != len(stream):
+        raise ProgramError("unexpected ')'")
+    return steps
+
+
+def parse_list(stream, index, depth):
+    steps = []
+    while index < len(stream):
+        token, value = stream[index]
+        if token == "close":
+            if not depth:
+                raise ProgramError("unexpected ')'")
+            return steps, index
+        if token == "sep":
+            index += 1
+            continue
+        if token == "repeat":
+            inner, index = parse_list(stream, index + 1, depth + 1)
+            if index >= len(stream) or stream[index][0] != "close":
+                raise ProgramError("missing ')'")
+            index += 1
+            if not inner:
+                raise ProgramError("nothing to repeat")
+            if value * len(inner) > MAX_SEGMENTS * 4:
+                raise ProgramError("too many steps")
+            steps.extend(inner * value)
+            continue
+        kind = duration = None
+        while index < len(stream) and stream[index][0] in ("kind", "duration"):
+            token, value = stream[index]
+            if token == "kind":
+                if kind is not None:
+                    break
+                kind = value
+            else:
+                if duration is not None:
+                    break
+                duration = value
+            index += 1
+        if kind is None or duration is None:
+            raise ProgramError("each step needs a kind and a duration")
+        if duration <= 0:
+            raise ProgramError("steps have to last a while")
+        steps.append((kind, duration))
+    if depth:
+        raise ProgramError("missing ')'")
+    return steps, index
+
+
+def compile_program(text):
+    """The segment table for text, as bytes."""
+    merged = []
+    for kind, duration in parse(text):
+        if merged and merged[-1][0] == kind and kind != WORK:
+            merged[-1] = (kind, merged[-1][1] + duration)
+        else:
+            merged.append((kind, duration))
+    if not merged:
+        raise ProgramError("empty program")
+    if len(merged) > MAX_SEGMENTS:
+        raise ProgramError("%d segments, the watch takes %d" % (len(merged), MAX_SEGMENTS))
+    rounds = sum(1 for kind, _ in merged if kind == WORK)
+    if not rounds:
+        raise ProgramError("no work steps; a program needs at least one round")
+    if rounds > MAX_ROUNDS:
+        raise ProgramError("%d rounds, the watch counts up to %d" % (rounds, MAX_ROUNDS))
+
+    table, end, work_seen = [], 0, 0
+    for kind, duration in merged:
+        end += duration
+        if end >= 2 ** 31:
+            raise ProgramError("program too long")
+        # A round counts as done once the next one starts.
+        table.append(SEGMENT.pack(end, kind, work_seen if kind == WORK else max(0, work_seen - 1)))
+        if kind == WORK:
+            work_seen += 1
+    return HEADER.pack(b"RP", VERSION, len(merged), rounds) + b"".join(table)
+
+
+def decode(data):
+    magic, version, count, rounds = HEADER.unpack_from(data)
+    segments = [SEGMENT.unpack_from(data, HEADER.size + i * SEGMENT.size) for i in range(count)]
+    return rounds, segments
+
+
+def describe(data):
+    rounds, segments = decode(data)
+    lines = ["%d segments, %d rounds, %d bytes" % (len(segments), rounds, len(data))]
+    start = 0
+    for end, kind, done in segments:
+        lines.append("  %8.1fs - %8.1fs  %-8s rounds done %d" % (start / 1000.0, end / 1000.0, NAMES[kind], done))
+        start = end
+    return "\n".join(lines)
+
+
+def random_program(rng, depth=0):
+    parts = []
+    for _ in range(rng.randint(1, 4)):
+        if depth < 2 and rng.random() < 0.3:
+            parts.append("%dx(%s)" % (rng.randint(1, 6), random_program(rng, depth + 1)))
+            continue
+        kind = rng.choice(list(KINDS))
+        duration = rng.choice(["%ds" % rng.randint(1, 90), "%dm" % rng.randint(1, 20), "%dm%ds" % (rng.randint(0, 9), rng.randint(1, 59)),
+                               "%d:%02d" % (rng.randint(0, 99), rng.randint(0, 59)), "1h"])
+        parts.append(rng.choice(["%s %s", "%s%s"]) % ((kind, duration) if rng.random() < 0.5 else (duration, kind)))
+    return rng.choice([";", ",", "; "]).join(parts)
+
+
+def fuzz(count):
+    rng = random.Random(1)
+    alphabet = "0123456789xhms:;,() workrestwarmupcooldown"
+    compiled = rejected = 0
+    for _ in range(count):
+        text = random_program(rng)
+        if rng.random() < 0.3:
+            # Mangle it a bit.
+            chars = list(text)
+            for _ in range(rng.randint(1, 3)):
+                chars.insert(rng.randint(0, len(chars)), rng.choice(alphabet))
+            text = "".join(chars)
+        try:
+            data = compile_program(text)
+        except ProgramError:
+            rejected += 1
+            continue
+        rounds, segments = decode(data)
+        ends = [end for end, _, _ in segments]
+        assert ends == sorted(set(ends)), text
+        assert rounds == sum(1 for _, kind, _ in segments if kind == 0) >= 1, text
+        done = [d for _, _, d in segments]
+        assert done == sorted(done) and (not done or done[-1] <= rounds), text
+        assert len(data) == HEADER.size + len(segments) * SEGMENT.size <= HEADER.size + MAX_SEGMENTS * SEGMENT.size, text
+        compiled += 1
+    print("%d compiled, %d rejected, no crashes" % (compiled, rejected))
+
+
+def bench(seconds=2.0):
+    text = "warmup 5m; 8x(20s work, 10s rest); 2x(3x(1m work, 30s rest), 2m rest); cooldown 3m"
+    count, began = 0, time.perf_counter()
+    while time.perf_counter() - began < seconds:
+        compile_program(text)
+        count += 1
+    took = time.perf_counter() - began
+    print("%.0f programs/s (%.1f us each)" % (count / took, took / count * 1e6))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("program", nargs="?")
+    parser.add_argument("--output", default=OUTPUT)
+    parser.add_argument("--clear", action="store_true", help="write an empty program")
+    parser.add_argument("--fuzz", type=int, metavar="N", help="compile N random programs and check the tables")
+    parser.add_argument("--bench", action="store_true", help="time the compiler")
+    args = parser.parse_args()
+
+    if args.fuzz:
+        fuzz(args.fuzz)
+    if args.bench:
+        bench()
+    if args.fuzz or args.bench:
+        return
+
+    if args.clear:
+        data = HEADER.pack(b"RP", VERSION, 0, 0)
+    elif args.program:
+        try:
+            data = compile_program(args.program)
+        except ProgramError as error:
+            sys.exit("program: %s" % error)
+        print(describe(data))
+    else:
+        parser.error("give a program, or --clear")
+    with open(args.output, "wb") as output:
+        output.write(data)
+
+
+if __name__ == "__main__":
+    main()
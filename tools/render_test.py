@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""Snapshot the app's screens on the host and compare them with the golden PNGs.
+
+Builds src/ against the host SDK in tools/host (pebble_host.c, with the
+1-bit screen in pebble_screen.c) and runs tools/host/render_test.c, which
+clicks through a short session and snapshots the screen along the way.
+Each snapshot is compared pixel for pixel with tools/golden/<name>.png.
+
+  render_test.py                   compare; exit 1 if any snapshot differs
+  render_test.py --out shots       also save this run's PNGs in shots/
+  render_test.py --write           take this run as the new golden images
+
+It also prints what the frames leading up to each snapshot cost: how
+many there were, the dirty rects and their area, the pixels drawn and
+changed, and the glyphs rasterized.
+"""
+
+import argparse
+import json
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HOST = os.path.join(ROOT, "tools", "host")
+GOLDEN = os.path.join(ROOT, "tools", "golden")
+RESOURCES = os.path.join(ROOT, "resources", "src")
+SOURCES = sorted(os.path.join(ROOT, "src", name) for name in os.listdir(os.path.join(ROOT, "src")) if name.endswith(".c"))
+SOURCES += [os.path.join(HOST, name) for name in ("pebble_host.c", "pebble_screen.c", "render_test.c")]
+COSTS = ["frames", "dirty_rects", "dirty_pixels", "drawn_pixels", "changed_pixels", "glyphs"]
+
+
+def read_png(path):
+    """(width, height, rows), each row a list of 1 for white and 0 for black.
+
+    Handles what the app's images and our own snapshots use: grey or
+    RGB(A), 1 or 8 bits, no interlacing."""
+    with open(path, "rb") as png:
+        data = png.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("%s isn't a PNG" % path)
+    pos, idat = 8, b""
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        if kind == b"IHDR":
+            width, height, depth, colour, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"IDAT":
+            idat += body
+        pos += 12 + length
+    channels = {0: 1, 2: 3, 6: 4}.get(colour)
+    if not channels or depth not in (1, 8) or (depth == 1 and channels != 1) or interlace:
+        raise ValueError("%s: unsupported PNG (depth %d, colour type %d)" % (path, depth, colour))
+
+    stride = (width * channels * depth + 7) // 8
+    step = max(1, channels * depth // 8)
+    raw = zlib.decompress(idat)
+    rows, previous = [], bytearray(stride)
+    for y in range(height):
+        kind, line = raw[y * (stride + 1)], bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            left = line[i - step] if i >= step else 0
+            up, corner = previous[i], previous[i - step] if i >= step else 0
+            if kind == 1:
+                line[i] = (line[i] + left) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + up) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + (left + up) // 2) & 0xFF
+            elif kind == 4:
+                guess = left + up - corner
+                best = min((abs(guess - left), 0, left), (abs(guess - up), 1, up), (abs(guess - corner), 2, corner))
+                line[i] = (line[i] + best[2]) & 0xFF
+        previous = line
+        if depth == 1:
+            rows.append([line[x // 8] >> (7 - x % 8) & 1 for x in range(width)])
+        else:
+            rows.append([1 if sum(line[x * channels:x * channels + min(channels, 3)]) >= 128 * min(channels, 3) else 0
+                         for x in range(width)])
+    return width, height, rows
+
+
+def write_png(path, width, height, rows):
+    """A 1-bit greyscale PNG."""
+    raw = b""
+    for row in rows:
+        packed = bytearray((width + 7) // 8)
+        for x, white in enumerate(row):
+            if white:
+                packed[x // 8] |= 0x80 >> (x % 8)
+        raw += b"\0" + bytes(packed)
+
+    def chunk(kind, body):
+        return struct.pack(">I", len(body)) + kind + body + struct.pack(">I", zlib.crc32(kind + body) & 0xFFFFFFFF)
+
+    with open(path, "wb") as png:
+        png.write(b"\x89PNG\r\n\x1a\n")
+        png.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 1, 0, 0, 0, 0)))
+        png.write(chunk(b"IDAT", zlib.compress(raw, 9)))
+        png.write(chunk(b"IEND", b""))
+
+
+def read_pbm(path):
+    with open(path, "rb") as pbm:
+        data = pbm.read()
+    magic, width, height, pixels = data.split(None, 3)
+    width, height, stride = int(width), int(height), (int(width) + 7) // 8
+    return width, height, [[0 if pixels[y * stride + x // 8] >> (7 - x % 8) & 1 else 1 for x in range(width)]
+                           for y in range(height)]
+
+
+def write_pbm(path, width, height, rows):
+    with open(path, "wb") as pbm:
+        pbm.write(b"P4\n%d %d\n" % (width, height))
+        for row in rows:
+            packed = bytearray((width + 7) // 8)
+            for x, white in enumerate(row):
+                if not white:
+                    packed[x // 8] |= 0x80 >> (x % 8)
+            pbm.write(bytes(packed))
+
+
+def convert_images(directory):
+    """The app's PNG resources as <defName>.pbm, for pebble_screen.c."""
+    with open(os.path.join(RESOURCES, "resource_map.json")) as resource_map:
+        media = json.load(resource_map)["media"]
+    for resource in media:
+        if resource["type"] == "png":
+            width, height, rows = read_png(os.path.join(RESOURCES, resource["file"]))
+            write_pbm(os.path.join(directory, resource["defName"] + ".pbm"), width, height, rows)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"))
+    parser.add_argument("--out", help="save this run's snapshots here as PNGs")
+    parser.add_argument("--write", action="store_true", help="save this run's snapshots as the golden images")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as build:
+        binary = os.path.join(build, "render_test")
+        subprocess.check_call([args.cc, "-O2", "-std=gnu99", "-Wall", "-fwrapv",
+                               "-I", HOST, "-I", os.path.join(ROOT, "src"), "-o", binary] + SOURCES)
+        resources, shots = os.path.join(build, "resources"), os.path.join(build, "shots")
+        os.mkdir(resources)
+        os.mkdir(shots)
+        convert_images(resources)
+        output = subprocess.check_output([binary, "-o", shots, "-r", resources], universal_newlines=True)
+
+        names = []
+        print("%-16s" % "snapshot" + "".join("%15s" % cost for cost in COSTS))
+        for line in output.splitlines():
+            if not line.startswith("{\"snapshot\""):
+                continue
+            record = json.loads(line)
+            names.append(record["snapshot"])
+            print("%-16s" % record["snapshot"] + "".join("%15d" % record[cost] for cost in COSTS))
+
+        for directory in (args.out, GOLDEN if args.write else None):
+            if directory:
+                os.makedirs(directory, exist_ok=True)
+                for name in names:
+                    write_png(os.path.join(directory, name + ".png"), *read_pbm(os.path.join(shots, name + ".pbm")))
+        if args.write:
+            return
+
+        failed = False
+        for name in names:
+            golden = os.path.join(GOLDEN, name + ".png")
+            if not os.path.exists(golden):
+                print("%s: no golden image" % name)
+                failed = True
+                continue
+            width, height, got = read_pbm(os.path.join(shots, name + ".pbm"))
+            golden_width, golden_height, wanted = read_png(golden)
+            if (width, height) != (golden_width, golden_height):
+                print("%s: %dx%d, the golden image is %dx%d" % (name, width, height, golden_width, golden_height))
+                failed = True
+                continue
+            differ = sum(a != b for row, golden_row in zip(got, wanted) for a, b in zip(row, golden_row))
+            if differ:
+                print("%s: %d pixels differ from %s" % (name, differ, os.path.relpath(golden, ROOT)))
+                failed = True
+        if failed:
+            sys.exit(1)
+        print("%d snapshots match" % len(names))
+
+
+if __name__ == "__main__":
+    main()
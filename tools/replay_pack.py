@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Turn a ROUNDTIMER_RECORD log into src/replay_trace.inc for a replay build.
+
+  replay_pack.py app.log            write src/replay_trace.inc
+  replay_pack.py app.log --dump     print the events instead
+
+See src/replay.h for the event format.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+OUTPUT = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "src", "replay_trace.inc")
+KINDS = {0: "gap", 1: "clock", 2: "click", 3: "appear"}
+WINDOWS = {0: "main", 1: "config"}
+BUTTONS = {0: "back", 1: "up", 2: "select", 3: "down"}
+
+
+def parse(lines):
+    """The last recording in the log: (first seconds, events)."""
+    first, expected, events, full = None, 0, [], False
+    for line in lines:
+        start = re.search(r"REPLAY start (-?\d+) (\d+)( full)?", line)
+        if start:
+            first, expected, events, full = int(start.group(1)), int(start.group(2)), [], bool(start.group(3))
+            continue
+        words = re.search(r"REPLAY ((?:[0-9a-f]{8} ?)+)$", line.strip())
+        if words and first is not None:
+            events.extend(int(word, 16) for word in words.group(1).split())
+    if first is None:
+        sys.exit("no REPLAY lines in the log")
+    events = events[:expected]
+    if len(events) < expected:
+        sys.exit("the log only has %d of %d events" % (len(events), expected))
+    if full:
+        print("the recording filled up; only its start can be replayed", file=sys.stderr)
+    return first, events
+
+
+def describe(event):
+    gap, kind, arg = event >> 16, (event >> 8) & 0xFF, event & 0xFF
+    if kind == 1:
+        what = "%+d s" % (arg - 256 if arg > 127 else arg)
+    elif kind == 2:
+        what = "%s %s%s" % (WINDOWS.get(arg >> 4, arg >> 4), BUTTONS.get((arg >> 1) & 7), " long" if arg & 1 else "")
+    elif kind == 3:
+        what = WINDOWS.get(arg, arg)
+    else:
+        what = ""
+    return gap, KINDS.get(kind, kind), what
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", type=argparse.FileType("r"), default=sys.stdin)
+    parser.add_argument("--output", default=OUTPUT)
+    parser.add_argument("--dump", action="store_true", help="list the events rather than writing them out")
+    args = parser.parse_args()
+
+    first, events = parse(args.log)
+    if args.dump:
+        at = 0
+        for event in events:
+            gap, kind, what = describe(event)
+            at += gap
+            print("%10d ms  %-6s %s" % (at, kind, what))
+        return
+
+    with open(args.output, "w") as output:
+        output.write("// Generated by tools/replay_pack.py; don't edit.\n")
+        output.write("static const time_t replay_first_seconds = %d;\n" % first)
+        output.write("static const uint32_t replay_events[] = {\n")
+        for i in range(0, len(events), 8):
+            output.write("    " + ", ".join("0x%08x" % event for event in events[i:i + 8]) + ",\n")
+        output.write("};\n")
+    print("%d events, %.1f s of wheel time" % (len(events), sum(event >> 16 for event in events) / 1000.0))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Sweep the round schedule arithmetic on the host (tools/host/schedule_sweep.c).
+
+Compiles src/round_timer.c against the stub SDK headers in tools/host and
+checks single_round_running_time(), get_round_period(), current_counter(),
+current_round_count() and time_to_next_boundary() against the loops they
+replaced, for every round, warning, rest and count the config screen can
+set. The sweep is split into one shard per core:
+
+  schedule_sweep.py                      everything, one shard per core
+  schedule_sweep.py --jobs 8             eight shards
+  schedule_sweep.py --passes every       just the millisecond-by-millisecond pass
+
+Mismatches are printed as they're found (the first 10 per shard) and the
+script exits 1 if there were any.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCES = [os.path.join(ROOT, "src", "round_timer.c"), os.path.join(ROOT, "tools", "host", "schedule_sweep.c")]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"))
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1, help="shards to run at once (default: every core)")
+    parser.add_argument("--passes", default="rounds,warning,every,sample")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as build:
+        binary = os.path.join(build, "schedule_sweep")
+        subprocess.check_call([args.cc, "-O2", "-std=gnu99", "-Wall",
+                               "-I", os.path.join(ROOT, "tools", "host"), "-I", os.path.join(ROOT, "src"),
+                               "-o", binary] + SOURCES)
+
+        began = time.time()
+        shards = [subprocess.Popen([binary, "-s", str(shard), "-n", str(args.jobs), "-p", args.passes],
+                                   stdout=subprocess.PIPE, universal_newlines=True)
+                  for shard in range(args.jobs)]
+        checks = failures = spare = 0
+        failed = False
+        for shard in shards:
+            output, _ = shard.communicate()
+            failed = failed or shard.returncode != 0
+            for line in output.splitlines():
+                total = re.match(r"total (\d+) checks (\d+) failures (\d+) spare_wakeups", line)
+                if total:
+                    checks += int(total.group(1))
+                    failures += int(total.group(2))
+                    spare += int(total.group(3))
+                elif line.startswith("FAIL"):
+                    print(line)
+
+    print("%d shards, %d checks, %d failures, %d spare wakeups, %.0f s" % (args.jobs, checks, failures, spare, time.time() - began))
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
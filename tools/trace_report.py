@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""Summarise a tick trace dumped by a ROUNDTIMER_TRACE build.
+
+Feed it the app log (e.g. `pebble logs > run.log`) and it prints
+histograms of how late each tick came against when it was due, the time
+between ticks, the corrections applied at each pebble second edge
+(jitter) and the clock drift between edges in parts per million. All of
+it is shared clock time; pass --plot to draw them with matplotlib.
+"""
+
+import argparse
+import re
+import sys
+from collections import Counter
+
+TRACE_LINE = re.compile(r"TRACE ([TE]) (-?\d+) (-?\d+)")
+
+
+def read_trace(stream):
+    ticks, edges = [], []
+    for line in stream:
+        match = TRACE_LINE.search(line)
+        if match:
+            entry = (int(match.group(2)), int(match.group(3)))
+            (ticks if match.group(1) == "T" else edges).append(entry)
+    return ticks, edges
+
+
+def histogram(title, values, width):
+    print(title)
+    if not values:
+        print("  (nothing recorded)\n")
+        return
+    bins = Counter((value // width) * width for value in values)
+    tallest = max(bins.values())
+    for start in sorted(bins):
+        bar = "#" * max(1, bins[start] * 50 // tallest)
+        print("  %7d..%-7d %5d %s" % (start, start + width - 1, bins[start], bar))
+    print("  n=%d min=%d max=%d mean=%.1f\n" % (len(values), min(values), max(values), sum(values) / len(values)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", type=argparse.FileType("r"), default=sys.stdin)
+    parser.add_argument("--bin", type=int, default=10, help="histogram bin width in ms")
+    parser.add_argument("--plot", action="store_true", help="draw the histograms with matplotlib")
+    args = parser.parse_args()
+
+    ticks, edges = read_trace(args.log)
+    if not ticks and not edges:
+        sys.exit("no TRACE lines found")
+
+    # A tick's value is how late it came; the gap to the one before is
+    # what the display actually got. The first edge only anchors.
+    lateness = [late for _, late in ticks]
+    gaps = [came_b - came_a for (came_a, _), (came_b, _) in zip(ticks, ticks[1:])]
+    jitter = [correction for _, correction in edges[1:]]
+    drift = []
+    for (at_a, _), (at_b, correction) in zip(edges, edges[1:]):
+        span = at_b - at_a
+        if span > 0:
+            drift.append(int(correction * 1000000 / span))
+
+    histogram("Tick lateness (ms)", lateness, args.bin)
+    histogram("Time between ticks (ms)", gaps, args.bin)
+    histogram("Correction at second edges (ms)", jitter, args.bin)
+    histogram("Drift between edges (ppm)", drift, 1000)
+
+    if args.plot:
+        import matplotlib.pyplot as plt
+        figure, axes = plt.subplots(1, 4, figsize=(15, 3.5))
+        titles = ("tick lateness (ms)", "between ticks (ms)", "correction (ms)", "drift (ppm)")
+        for axis, title, values in zip(axes, titles, (lateness, gaps, jitter, drift)):
+            axis.hist(values, bins=30)
+            axis.set_title(title)
+        plt.tight_layout()
+        plt.show()
+
+
+if __name__ == "__main__":
+    main()